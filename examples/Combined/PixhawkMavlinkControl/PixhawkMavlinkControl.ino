@@ -0,0 +1,103 @@
+/*
+  PixhawkMavlinkControl - Motors and servos as MAVLink actuators
+
+  The Pixhawk drives the controllers directly over MAVLink v2 with
+  HiTechnicMavlink, with no text bridge on either side: each of the eight
+  actuator controls (-1..1) of control group 0 is mapped onto one motor
+  or servo. Encoder positions come back as NAMED_VALUE_INT ("ENC1".."ENC6")
+  and velocities as DEBUG_VECT ("VEL1", "VEL4"), both visible in the
+  QGroundControl MAVLink Inspector.
+
+  Hardware Setup:
+  - Arduino Mega 2560
+  - Pixhawk TELEM2 → Arduino Serial1 (pins 18/19), MAVLink 2 at 57600
+  - 3x HiTechnic TETRIX Motor Controllers at 0x01, 0x02, 0x03
+  - 1x HiTechnic TETRIX Servo Controller at 0x04
+  - 10kΩ resistor from Pin 22 to first controller Pin 5
+  - I2C: Pin 20 (SDA), Pin 21 (SCL)
+
+  Channels (controls[] of SET_ACTUATOR_CONTROL_TARGET or
+  ACTUATOR_CONTROL_TARGET, group 0):
+    0-5  Motors 1-6, power = control * 100
+    6-7  Servos 1-2, position = (control + 1) * 127.5
+*/
+
+#include <HiTechnicMotor.h>
+#include <HiTechnicServo.h>
+#include <HiTechnicChain.h>
+#include <HiTechnicMavlink.h>
+
+#define PIXHAWK_SERIAL Serial1
+#define PIXHAWK_BAUD 57600
+
+#define SYSTEM_ID 1              // Same system as the autopilot
+#define COMMAND_TIMEOUT 1000     // Stop motors if no controls for 1 second
+#define TELEMETRY_RATE 50        // ms (20 Hz)
+#define HEARTBEAT_RATE 1000      // ms
+
+HiTechnicMotor controller1(0x01);  // Motors 1 & 2
+HiTechnicMotor controller2(0x02);  // Motors 3 & 4
+HiTechnicMotor controller3(0x03);  // Motors 5 & 6
+HiTechnicMotor* controllers[3] = {&controller1, &controller2, &controller3};
+HiTechnicServo servos(0x04);
+HiTechnicChain chain;
+
+HiTechnicMavlink mavlink(PIXHAWK_SERIAL, SYSTEM_ID);
+
+unsigned long lastCommandTime = 0;
+unsigned long lastTelemetryTime = 0;
+unsigned long lastHeartbeatTime = 0;
+
+void setup() {
+  PIXHAWK_SERIAL.begin(PIXHAWK_BAUD);
+
+  pinMode(22, OUTPUT);
+  digitalWrite(22, HIGH);  // Analog detection for the daisy chain
+
+  chain.addMotor(controller1);
+  chain.addMotor(controller2);
+  chain.addMotor(controller3);
+  chain.addServo(servos);
+  chain.begin();
+
+  // Channel order = controls[] index
+  for (uint8_t i = 0; i < 3; i++) {
+    mavlink.addMotor(*controllers[i], MOTOR_1);
+    mavlink.addMotor(*controllers[i], MOTOR_2);
+  }
+  mavlink.addServo(servos, 1);
+  mavlink.addServo(servos, 2);
+
+  lastCommandTime = millis();
+}
+
+void loop() {
+  while (PIXHAWK_SERIAL.available()) {
+    if (mavlink.parse(PIXHAWK_SERIAL.read()) && mavlink.apply()) {
+      lastCommandTime = millis();
+    }
+  }
+
+  // Watchdog
+  if (millis() - lastCommandTime > COMMAND_TIMEOUT) {
+    chain.stopAll();
+    lastCommandTime = millis();
+  }
+
+  chain.update();
+
+  if (millis() - lastTelemetryTime >= TELEMETRY_RATE) {
+    // One snapshot read per controller (3 transactions for 6 encoders)
+    for (uint8_t i = 0; i < 3; i++) {
+      controllers[i]->readState();
+    }
+    mavlink.sendEncoders();
+    mavlink.sendVelocities();
+    lastTelemetryTime = millis();
+  }
+
+  if (millis() - lastHeartbeatTime >= HEARTBEAT_RATE) {
+    mavlink.sendHeartbeat();
+    lastHeartbeatTime = millis();
+  }
+}
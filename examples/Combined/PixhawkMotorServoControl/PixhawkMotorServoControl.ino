@@ -39,6 +39,7 @@
 
 #include <HiTechnicMotor.h>
 #include <HiTechnicServo.h>
+#include <HiTechnicSerialScheduler.h>
 
 // Serial configuration
 #define PIXHAWK_SERIAL Serial1
@@ -61,6 +62,11 @@ HiTechnicMotor controller3(0x03);  // Motors 5 & 6
 // Servo controller at I2C address 0x04
 HiTechnicServo servos(0x04);       // Servos 1-6
 
+// Queued, non-blocking output: acks before telemetry on the Pixhawk
+// link; debug text is dropped rather than stalling loop()
+HiTechnicSerialScheduler pixhawkOut(PIXHAWK_SERIAL);
+HiTechnicSerialScheduler debugOut(DEBUG_SERIAL);
+
 // Command buffer
 char cmdBuffer[64];
 uint8_t cmdIndex = 0;
@@ -111,10 +117,17 @@ void setup() {
   DEBUG_SERIAL.println(F("\nWaiting for commands from Pixhawk..."));
   DEBUG_SERIAL.println(F("Motor: M1:50, Servo: S1:90, Stop: STOP"));
   
+  pixhawkOut.setCapacity(64, 192, 0);
+  debugOut.setCapacity(0, 0, HT_TX_BUFFER_SIZE);
+  
   lastCommandTime = millis();
 }
 
 void loop() {
+  // Hand queued output to the serial ports as their buffers drain
+  pixhawkOut.update();
+  debugOut.update();
+  
   // Check for commands from Pixhawk
   while (PIXHAWK_SERIAL.available()) {
     char c = PIXHAWK_SERIAL.read();
@@ -150,9 +163,10 @@ void loop() {
 
 void processCommand(const char* cmd) {
   lastCommandTime = millis();
+  pixhawkOut.setPriority(HT_TX_ACK);
   
-  DEBUG_SERIAL.print(F("CMD: "));
-  DEBUG_SERIAL.println(cmd);
+  debugOut.print(F("CMD: "));
+  debugOut.println(cmd);
   
   // Motor commands (M1-M6)
   if (cmd[0] == 'M' && cmd[1] >= '1' && cmd[1] <= '6' && cmd[2] == ':') {
@@ -162,10 +176,10 @@ void processCommand(const char* cmd) {
     
     setMotorPower(motorNum, power);
     
-    PIXHAWK_SERIAL.print(F("OK,M"));
-    PIXHAWK_SERIAL.print(motorNum);
-    PIXHAWK_SERIAL.print(F(":"));
-    PIXHAWK_SERIAL.println(power);
+    pixhawkOut.print(F("OK,M"));
+    pixhawkOut.print(motorNum);
+    pixhawkOut.print(F(":"));
+    pixhawkOut.println(power);
     
   // Servo commands (S1-S6)
   } else if (cmd[0] == 'S' && cmd[1] >= '1' && cmd[1] <= '6' && cmd[2] == ':') {
@@ -175,36 +189,36 @@ void processCommand(const char* cmd) {
     
     servos.setServoAngle(servoNum, angle);
     
-    PIXHAWK_SERIAL.print(F("OK,S"));
-    PIXHAWK_SERIAL.print(servoNum);
-    PIXHAWK_SERIAL.print(F(":"));
-    PIXHAWK_SERIAL.println(angle);
+    pixhawkOut.print(F("OK,S"));
+    pixhawkOut.print(servoNum);
+    pixhawkOut.print(F(":"));
+    pixhawkOut.println(angle);
     
-    DEBUG_SERIAL.print(F("Servo "));
-    DEBUG_SERIAL.print(servoNum);
-    DEBUG_SERIAL.print(F(" → "));
-    DEBUG_SERIAL.print(angle);
-    DEBUG_SERIAL.println(F("°"));
+    debugOut.print(F("Servo "));
+    debugOut.print(servoNum);
+    debugOut.print(F(" → "));
+    debugOut.print(angle);
+    debugOut.println(F("°"));
     
   // Emergency stop motors
   } else if (strcmp(cmd, "STOP") == 0) {
     emergencyStop();
-    PIXHAWK_SERIAL.println(F("STOPPED"));
-    DEBUG_SERIAL.println(F("EMERGENCY STOP"));
+    pixhawkOut.println(F("STOPPED"));
+    debugOut.println(F("EMERGENCY STOP"));
     
   // Center all servos
   } else if (strcmp(cmd, "SCENTER") == 0) {
     servos.centerAll();
-    PIXHAWK_SERIAL.println(F("SERVOS_CENTERED"));
-    DEBUG_SERIAL.println(F("All servos centered"));
+    pixhawkOut.println(F("SERVOS_CENTERED"));
+    debugOut.println(F("All servos centered"));
     
   // Disable all servos
   } else if (strcmp(cmd, "SDISABLE") == 0) {
     for (int i = 1; i <= 6; i++) {
       servos.disableServo(i);
     }
-    PIXHAWK_SERIAL.println(F("SERVOS_DISABLED"));
-    DEBUG_SERIAL.println(F("All servos disabled"));
+    pixhawkOut.println(F("SERVOS_DISABLED"));
+    debugOut.println(F("All servos disabled"));
     
   // Status request
   } else if (strcmp(cmd, "STATUS") == 0) {
@@ -215,7 +229,7 @@ void processCommand(const char* cmd) {
     controller1.resetAllEncoders();
     controller2.resetAllEncoders();
     controller3.resetAllEncoders();
-    PIXHAWK_SERIAL.println(F("ENCODERS_RESET"));
+    pixhawkOut.println(F("ENCODERS_RESET"));
     
   // Reset everything
   } else if (strcmp(cmd, "RESET_ALL") == 0) {
@@ -223,8 +237,8 @@ void processCommand(const char* cmd) {
     controller2.resetAllEncoders();
     controller3.resetAllEncoders();
     servos.centerAll();
-    PIXHAWK_SERIAL.println(F("ALL_RESET"));
-    DEBUG_SERIAL.println(F("Encoders reset, servos centered"));
+    pixhawkOut.println(F("ALL_RESET"));
+    debugOut.println(F("Encoders reset, servos centered"));
     
   // All motors same power
   } else if (strncmp(cmd, "MALL:", 5) == 0) {
@@ -235,15 +249,15 @@ void processCommand(const char* cmd) {
       setMotorPower(i, power);
     }
     
-    PIXHAWK_SERIAL.print(F("OK,MALL:"));
-    PIXHAWK_SERIAL.println(power);
+    pixhawkOut.print(F("OK,MALL:"));
+    pixhawkOut.println(power);
     
   // Unknown command
   } else {
-    PIXHAWK_SERIAL.print(F("ERROR,UNKNOWN:"));
-    PIXHAWK_SERIAL.println(cmd);
-    DEBUG_SERIAL.print(F("Unknown: "));
-    DEBUG_SERIAL.println(cmd);
+    pixhawkOut.print(F("ERROR,UNKNOWN:"));
+    pixhawkOut.println(cmd);
+    debugOut.print(F("Unknown: "));
+    debugOut.println(cmd);
   }
 }
 
@@ -269,11 +283,11 @@ void setMotorPower(uint8_t motorNum, int8_t power) {
       break;
   }
   
-  DEBUG_SERIAL.print(F("Motor "));
-  DEBUG_SERIAL.print(motorNum);
-  DEBUG_SERIAL.print(F(" → "));
-  DEBUG_SERIAL.print(power);
-  DEBUG_SERIAL.println(F("%"));
+  debugOut.print(F("Motor "));
+  debugOut.print(motorNum);
+  debugOut.print(F(" → "));
+  debugOut.print(power);
+  debugOut.println(F("%"));
 }
 
 void emergencyStop() {
@@ -283,49 +297,56 @@ void emergencyStop() {
 }
 
 void sendTelemetry() {
-  PIXHAWK_SERIAL.print(F("TELEM"));
+  pixhawkOut.setPriority(HT_TX_TELEMETRY);
+  
+  // One snapshot read per controller (3 transactions for 6 encoders)
+  controller1.readState();
+  controller2.readState();
+  controller3.readState();
+  
+  pixhawkOut.print(F("TELEM"));
   
   // Motor telemetry
-  PIXHAWK_SERIAL.print(F(",M1:P:"));
-  PIXHAWK_SERIAL.print(controller1.getCurrentPower(MOTOR_1));
-  PIXHAWK_SERIAL.print(F(",E:"));
-  PIXHAWK_SERIAL.print(controller1.readEncoder(MOTOR_1));
+  pixhawkOut.print(F(",M1:P:"));
+  pixhawkOut.print(controller1.getCurrentPower(MOTOR_1));
+  pixhawkOut.print(F(",E:"));
+  pixhawkOut.print(controller1.getEncoder(MOTOR_1));
   
-  PIXHAWK_SERIAL.print(F(",M2:P:"));
-  PIXHAWK_SERIAL.print(controller1.getCurrentPower(MOTOR_2));
-  PIXHAWK_SERIAL.print(F(",E:"));
-  PIXHAWK_SERIAL.print(controller1.readEncoder(MOTOR_2));
+  pixhawkOut.print(F(",M2:P:"));
+  pixhawkOut.print(controller1.getCurrentPower(MOTOR_2));
+  pixhawkOut.print(F(",E:"));
+  pixhawkOut.print(controller1.getEncoder(MOTOR_2));
   
-  PIXHAWK_SERIAL.print(F(",M3:P:"));
-  PIXHAWK_SERIAL.print(controller2.getCurrentPower(MOTOR_1));
-  PIXHAWK_SERIAL.print(F(",E:"));
-  PIXHAWK_SERIAL.print(controller2.readEncoder(MOTOR_1));
+  pixhawkOut.print(F(",M3:P:"));
+  pixhawkOut.print(controller2.getCurrentPower(MOTOR_1));
+  pixhawkOut.print(F(",E:"));
+  pixhawkOut.print(controller2.getEncoder(MOTOR_1));
   
-  PIXHAWK_SERIAL.print(F(",M4:P:"));
-  PIXHAWK_SERIAL.print(controller2.getCurrentPower(MOTOR_2));
-  PIXHAWK_SERIAL.print(F(",E:"));
-  PIXHAWK_SERIAL.print(controller2.readEncoder(MOTOR_2));
+  pixhawkOut.print(F(",M4:P:"));
+  pixhawkOut.print(controller2.getCurrentPower(MOTOR_2));
+  pixhawkOut.print(F(",E:"));
+  pixhawkOut.print(controller2.getEncoder(MOTOR_2));
   
-  PIXHAWK_SERIAL.print(F(",M5:P:"));
-  PIXHAWK_SERIAL.print(controller3.getCurrentPower(MOTOR_1));
-  PIXHAWK_SERIAL.print(F(",E:"));
-  PIXHAWK_SERIAL.print(controller3.readEncoder(MOTOR_1));
+  pixhawkOut.print(F(",M5:P:"));
+  pixhawkOut.print(controller3.getCurrentPower(MOTOR_1));
+  pixhawkOut.print(F(",E:"));
+  pixhawkOut.print(controller3.getEncoder(MOTOR_1));
   
-  PIXHAWK_SERIAL.print(F(",M6:P:"));
-  PIXHAWK_SERIAL.print(controller3.getCurrentPower(MOTOR_2));
-  PIXHAWK_SERIAL.print(F(",E:"));
-  PIXHAWK_SERIAL.print(controller3.readEncoder(MOTOR_2));
+  pixhawkOut.print(F(",M6:P:"));
+  pixhawkOut.print(controller3.getCurrentPower(MOTOR_2));
+  pixhawkOut.print(F(",E:"));
+  pixhawkOut.print(controller3.getEncoder(MOTOR_2));
   
   // Servo telemetry (positions in degrees)
   for (int i = 1; i <= 6; i++) {
     uint8_t pos = servos.getServoPosition(i);
     uint8_t angle = map(pos, 0, 255, 0, 180);
     
-    PIXHAWK_SERIAL.print(F(",S"));
-    PIXHAWK_SERIAL.print(i);
-    PIXHAWK_SERIAL.print(F(":"));
-    PIXHAWK_SERIAL.print(angle);
+    pixhawkOut.print(F(",S"));
+    pixhawkOut.print(i);
+    pixhawkOut.print(F(":"));
+    pixhawkOut.print(angle);
   }
   
-  PIXHAWK_SERIAL.println();
+  pixhawkOut.println();
 }
@@ -0,0 +1,80 @@
+/*
+  Ramp Profile Self Test
+
+  Runs every shaped ramp profile through a full reversal (-100 to +100
+  and back) on a HiTechnicMockBus and checks the powers written along the
+  way: each step must move toward the target, stay within -100..100 and
+  match what getCurrentPower() reports, and the ramp must end on the
+  target. No controllers are needed; only the board's serial port.
+
+  Hardware:
+  - Any Arduino (the ramp math runs with the board's own int size, so on
+    an AVR board this exercises 16-bit arithmetic)
+*/
+
+#include <HiTechnicMotor.h>
+#include <HiTechnicMockBus.h>
+
+#define MOCK_ADDRESS 0x01
+#define RAMP_TIMEOUT 2000  // ms
+
+HiTechnicMockBus bus;
+HiTechnicMotor motor(MOCK_ADDRESS, bus);
+
+uint8_t failures = 0;
+
+// Ramp from one power to another and check every step written
+void checkRamp(uint8_t profile, const char* name, int8_t from, int8_t to) {
+  motor.setRampProfile(MOTOR_1, HT_PROFILE_LINEAR);
+  motor.setMotorPower(MOTOR_1, from);
+  motor.setRampProfile(MOTOR_1, profile);
+  motor.setMotorPowerSmooth(MOTOR_1, to, 20, 20);
+
+  int8_t last = from;
+  bool ok = true;
+  unsigned long start = millis();
+  while (motor.update() && millis() - start < RAMP_TIMEOUT) {
+    int8_t power = motor.getCurrentPower(MOTOR_1);
+    int8_t written = (int8_t)bus.registers(MOCK_ADDRESS)[HT_MOTOR1_POWER];
+    bool toward = (to > from) ? (power >= last) : (power <= last);
+    if (!toward || power < -100 || power > 100 || written != power) {
+      ok = false;
+    }
+    last = power;
+    delay(1);
+  }
+  if (motor.getCurrentPower(MOTOR_1) != to) {
+    ok = false;
+  }
+
+  Serial.print(ok ? F("PASS  ") : F("FAIL  "));
+  Serial.print(name);
+  Serial.print(F(" "));
+  Serial.print(from);
+  Serial.print(F(" -> "));
+  Serial.println(to);
+  if (!ok) {
+    failures++;
+  }
+}
+
+void setup() {
+  Serial.begin(9600);
+  Serial.println(F("\n=== Ramp Profile Self Test ==="));
+
+  bus.addDevice(MOCK_ADDRESS);
+  motor.begin();
+
+  checkRamp(HT_PROFILE_LINEAR, "linear", -100, 100);
+  checkRamp(HT_PROFILE_LINEAR, "linear", 100, -100);
+  checkRamp(HT_PROFILE_EXPONENTIAL, "exponential", -100, 100);
+  checkRamp(HT_PROFILE_EXPONENTIAL, "exponential", 100, -100);
+  checkRamp(HT_PROFILE_SCURVE, "s-curve", -100, 100);
+  checkRamp(HT_PROFILE_SCURVE, "s-curve", 100, -100);
+
+  Serial.print(failures);
+  Serial.println(F(" failure(s)"));
+}
+
+void loop() {
+}
@@ -2,6 +2,8 @@
   Simple Acceleration Test
   
   Tests smooth acceleration on a single motor with debug output.
+  Uses the three-phase freewheel ramp profile: coast for 1 second,
+  controlled deceleration, then coast once power drops below 25%.
 */
 
 #include "HiTechnicMotor.h"
@@ -21,6 +23,7 @@ void setup() {
   
   motor.begin();
   motor.setAcceleration(1);  // 1 = ~2 second ramp to 100%
+  motor.setRampProfile(MOTOR_1, HT_PROFILE_FREEWHEEL);
   
   Serial.println("Motor initialized");
   Serial.println("Starting 2-second ramp test...\n");
@@ -0,0 +1,90 @@
+/*
+  Async Encoder Reading Example
+
+  This example reads the encoders of three motor controllers while loop()
+  keeps handling serial commands. Snapshot reads are queued on HTAsyncI2C;
+  HTAsyncI2C.poll() moves them along and delivers the results. Built with
+  -DHT_ASYNC_I2C_ISR the transfers run in the background from the TWI
+  interrupt and poll() only delivers them.
+
+  Serial commands (9600 baud):
+    1..6  - run that motor at 50% power
+    0     - stop all motors
+
+  Connections:
+  - Arduino SDA (Pin 20) -> HiTechnic SDA
+  - Arduino SCL (Pin 21) -> HiTechnic SCL
+  - Pin 22 -> 10kΩ resistor -> first controller Pin 5 (daisy chain addressing)
+  - Connect GND between Arduino and HiTechnic controllers
+*/
+
+#include "HiTechnicMotor.h"
+
+#define ANALOG_DETECT_PIN 22
+#define PRINT_INTERVAL 250
+
+HiTechnicMotor controllers[3] = {
+  HiTechnicMotor(0x01),
+  HiTechnicMotor(0x02),
+  HiTechnicMotor(0x03)
+};
+
+unsigned long lastPrintTime = 0;
+
+void setup() {
+  Serial.begin(9600);
+  Serial.println("HiTechnic Motor Controller - Async Encoder Example");
+
+  // Enable daisy chain addressing
+  pinMode(ANALOG_DETECT_PIN, OUTPUT);
+  digitalWrite(ANALOG_DETECT_PIN, HIGH);
+
+  for (int i = 0; i < 3; i++) {
+    controllers[i].begin();
+  }
+  HTAsyncI2C.begin();
+}
+
+void loop() {
+  // Step the I2C engine through every ready bus event and deliver finished
+  // reads; this never waits
+  HTAsyncI2C.poll();
+
+  // Keep one snapshot read queued per controller
+  for (int i = 0; i < 3; i++) {
+    if (!controllers[i].isAsyncBusy()) {
+      controllers[i].readStateAsync();
+    }
+  }
+
+  // Serial commands are handled while the reads are in flight. Blocking
+  // driver calls finish the queued reads before they touch the bus.
+  if (Serial.available()) {
+    char c = Serial.read();
+    if (c >= '1' && c <= '6') {
+      uint8_t index = (c - '1') / 2;
+      uint8_t motor = ((c - '1') % 2 == 0) ? MOTOR_1 : MOTOR_2;
+      controllers[index].setMotorPower(motor, 50);
+    } else if (c == '0') {
+      for (int i = 0; i < 3; i++) {
+        controllers[i].stopAll();
+      }
+    }
+  }
+
+  // Print the latest completed snapshots
+  if (millis() - lastPrintTime >= PRINT_INTERVAL) {
+    lastPrintTime = millis();
+    for (int i = 0; i < 3; i++) {
+      Serial.print("E");
+      Serial.print(i * 2 + 1);
+      Serial.print(":");
+      Serial.print(controllers[i].getEncoder(MOTOR_1));
+      Serial.print(" E");
+      Serial.print(i * 2 + 2);
+      Serial.print(":");
+      Serial.print(controllers[i].getEncoder(MOTOR_2));
+      Serial.print(i < 2 ? "  " : "\n");
+    }
+  }
+}
@@ -0,0 +1,68 @@
+/*
+  Coordinated Move Example
+  
+  Moves three motors of a gantry (X and Y on controller 1, Z on
+  controller 2) between waypoints so all axes start and finish together.
+  The chain streams jerk-limited position targets at 100 Hz, one burst
+  per controller per tick.
+  
+  Hardware:
+  - Arduino Mega 2560
+  - 2x HiTechnic DC Motor Controllers (addresses 0x01, 0x02)
+  - TETRIX motors with encoders
+  
+  Connections:
+  - SDA (Pin 20) → All controllers Pin 6
+  - SCL (Pin 21) → All controllers Pin 5
+  - GND → All controllers Pin 1/2
+*/
+
+#include "HiTechnicMotor.h"
+#include "HiTechnicChain.h"
+#include "HiTechnicMove.h"
+
+HiTechnicMotor controller1(0x01);
+HiTechnicMotor controller2(0x02);
+HiTechnicChain chain;
+HiTechnicMove gantry;
+
+// Waypoints in encoder counts: X, Y, Z
+const int32_t waypoints[][3] = {
+  {4000, 1500,  -800},
+  {1000, 3000,     0},
+  {   0,    0,     0}
+};
+const uint8_t waypointCount = sizeof(waypoints) / sizeof(waypoints[0]);
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("=== Coordinated Move ===");
+  
+  chain.addMotor(controller1);
+  chain.addMotor(controller2);
+  chain.begin();
+  
+  gantry.addAxis(controller1, MOTOR_1);  // X
+  gantry.addAxis(controller1, MOTOR_2);  // Y
+  gantry.addAxis(controller2, MOTOR_1);  // Z
+  gantry.setLimits(2, 720, 1440, 7200);  // Z is slower
+  chain.addMove(gantry);
+  
+  if (!chain.setControlRate(100)) {
+    Serial.println("Bus too slow for 100 Hz, keeping 50 Hz");
+  }
+}
+
+void loop() {
+  for (uint8_t i = 0; i < waypointCount; i++) {
+    gantry.moveTo(waypoints[i]);
+    Serial.print("Waypoint ");
+    Serial.print(i);
+    Serial.print(", ");
+    Serial.print(gantry.getDuration() / 1000);
+    Serial.println(" ms");
+    
+    while (chain.update()) { }
+    delay(500);
+  }
+}
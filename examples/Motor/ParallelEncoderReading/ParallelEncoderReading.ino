@@ -0,0 +1,91 @@
+/*
+  Parallel Encoder Reading Example
+
+  Three separate I2C chains share one SCL line, each with its own SDA
+  line on port A of an Arduino Mega. A SoftwareI2CGroup reads both
+  encoders (0x50-0x57) of the first controller on every chain in one
+  lockstep transaction, so three snapshots cost the bus time of one.
+
+  Setup commands go through a SoftwareI2C per chain on the same pins;
+  only one of them drives the lines at a time.
+
+  Connections:
+  - Pin 22 (PA0) -> chain 1 SDA
+  - Pin 23 (PA1) -> chain 2 SDA
+  - Pin 24 (PA2) -> chain 3 SDA
+  - Pin 25 (PA3) -> SCL of all three chains
+  - 4.7kΩ pull-up on every SDA line and on SCL
+  - Connect GND between Arduino and HiTechnic controllers
+*/
+
+#include "HiTechnicMotor.h"
+#include "SoftwareI2C.h"
+#include "SoftwareI2CGroup.h"
+
+#define CHAINS 3
+#define SCL_PIN 25
+#define PRINT_INTERVAL 250
+
+const uint8_t sdaPins[CHAINS] = {22, 23, 24};
+
+SoftwareI2C bus1(22, SCL_PIN);
+SoftwareI2C bus2(23, SCL_PIN);
+SoftwareI2C bus3(24, SCL_PIN);
+
+HiTechnicMotor controllers[CHAINS] = {
+  HiTechnicMotor(0x01, bus1),
+  HiTechnicMotor(0x01, bus2),
+  HiTechnicMotor(0x01, bus3)
+};
+
+SoftwareI2CGroup chains(sdaPins, CHAINS, SCL_PIN);
+
+uint8_t encoders[CHAINS * 8];
+unsigned long lastPrintTime = 0;
+
+int32_t decode(const uint8_t* data) {
+  return ((int32_t)data[0] << 24) | ((int32_t)data[1] << 16) |
+         ((int32_t)data[2] << 8) | (int32_t)data[3];
+}
+
+void setup() {
+  Serial.begin(9600);
+  Serial.println("HiTechnic Motor Controller - Parallel Encoder Example");
+
+  for (int i = 0; i < CHAINS; i++) {
+    controllers[i].begin();
+    controllers[i].setMotorPower(MOTOR_BOTH, 30);
+  }
+
+  if (!chains.begin()) {
+    Serial.println("SDA pins must share one port");
+    while (1) {
+    }
+  }
+}
+
+void loop() {
+  // Keep the controllers' 2.5 s timeout from floating the motors
+  for (int i = 0; i < CHAINS; i++) {
+    controllers[i].flush();
+  }
+
+  if (millis() - lastPrintTime >= PRINT_INTERVAL) {
+    lastPrintTime = millis();
+
+    uint8_t answered = chains.readRegisters(0x01, HT_ENCODER1_CURRENT, encoders, 8);
+
+    for (int i = 0; i < CHAINS; i++) {
+      Serial.print("Chain ");
+      Serial.print(i + 1);
+      if (answered & (1 << i)) {
+        Serial.print(": M1=");
+        Serial.print(decode(encoders + i * 8));
+        Serial.print(" M2=");
+        Serial.println(decode(encoders + i * 8 + 4));
+      } else {
+        Serial.println(": no response");
+      }
+    }
+  }
+}
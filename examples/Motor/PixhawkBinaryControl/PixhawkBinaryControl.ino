@@ -0,0 +1,145 @@
+/*
+  PixhawkBinaryControl - Binary framed motor link for Pixhawk/companion computers
+  
+  Same job as PixhawkMotorControl, using HiTechnicProtocol frames instead
+  of text lines: commands are parsed byte by byte as they arrive, each is
+  acknowledged with a 10-byte HT_MSG_ACK frame, and telemetry for all six
+  motors goes through a HiTechnicTelemetryStream: a 40-byte keyframe once
+  a second and deltas of about 10-25 bytes in between, so it can be sent
+  at 50 Hz on the same 57600 baud link. The Pixhawk side acknowledges
+  keyframes with HT_MSG_ACK.
+  
+  Hardware Setup:
+  - Arduino Mega 2560
+  - Pixhawk TELEM2 → Arduino Serial1 (pins 18/19)
+  - 3x HiTechnic TETRIX Motor Controllers at addresses 0x01, 0x02, 0x03
+  - 10kΩ resistor from Pin 22 to first controller Pin 5
+  - I2C: Pin 20 (SDA), Pin 21 (SCL)
+  
+  Messages (see HiTechnicProtocol.h for the frame layout):
+    HT_MSG_MOTOR_COMMAND     - mask + six powers, applied with smooth ramping
+    HT_MSG_STOP              - emergency stop
+    HT_MSG_RESET_ENCODERS    - reset all encoders
+    HT_MSG_TELEMETRY_REQUEST - send telemetry now
+*/
+
+#include <HiTechnicMotor.h>
+#include <HiTechnicChain.h>
+#include <HiTechnicProtocol.h>
+#include <HiTechnicTelemetryStream.h>
+
+#define PIXHAWK_SERIAL Serial1
+#define PIXHAWK_BAUD 57600
+
+#define COMMAND_TIMEOUT 1000     // Stop motors if no command for 1 second
+#define MAX_MOTOR_POWER 100
+#define TELEMETRY_RATE 20        // ms (50 Hz)
+#define ACCEL_RATE 5
+
+HiTechnicMotor controller1(0x01);  // Motors 1 & 2
+HiTechnicMotor controller2(0x02);  // Motors 3 & 4
+HiTechnicMotor controller3(0x03);  // Motors 5 & 6
+HiTechnicMotor* controllers[3] = {&controller1, &controller2, &controller3};
+HiTechnicChain chain;
+
+HiTechnicProtocol link(PIXHAWK_SERIAL);
+HiTechnicTelemetryStream telemetryStream(link);
+
+unsigned long lastCommandTime = 0;
+unsigned long lastTelemetryTime = 0;
+
+void setup() {
+  PIXHAWK_SERIAL.begin(PIXHAWK_BAUD);
+  
+  pinMode(22, OUTPUT);
+  digitalWrite(22, HIGH);  // Analog detection for the daisy chain
+  
+  chain.addMotor(controller1);
+  chain.addMotor(controller2);
+  chain.addMotor(controller3);
+  chain.begin();
+  
+  lastCommandTime = millis();
+}
+
+void loop() {
+  // Frames are assembled in place as bytes arrive
+  while (PIXHAWK_SERIAL.available()) {
+    // Keyframe acknowledgments are consumed by the telemetry stream
+    if (link.parse(PIXHAWK_SERIAL.read()) && !telemetryStream.handleFrame()) {
+      handleFrame();
+    }
+  }
+  
+  // Watchdog
+  if (millis() - lastCommandTime > COMMAND_TIMEOUT) {
+    chain.stopAll();
+    lastCommandTime = millis();
+  }
+  
+  chain.update();
+  
+  if (millis() - lastTelemetryTime >= TELEMETRY_RATE) {
+    sendTelemetry();
+    lastTelemetryTime = millis();
+  }
+}
+
+void handleFrame() {
+  lastCommandTime = millis();
+  
+  switch (link.getMessageId()) {
+    case HT_MSG_MOTOR_COMMAND: {
+      HiTechnicMotorCommand command;
+      if (!link.readCommand(command)) {
+        link.sendAck(HT_ACK_REJECTED);
+        return;
+      }
+      for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+        if (command.motorMask & (1 << i)) {
+          int8_t power = constrain(command.powers[i], -MAX_MOTOR_POWER, MAX_MOTOR_POWER);
+          controllers[i / 2]->setMotorPowerSmooth((i % 2) ? MOTOR_2 : MOTOR_1, power, ACCEL_RATE);
+        }
+      }
+      link.sendAck(HT_ACK_OK);
+      break;
+    }
+    
+    case HT_MSG_STOP:
+      chain.stopAll();
+      link.sendAck(HT_ACK_OK);
+      break;
+      
+    case HT_MSG_RESET_ENCODERS:
+      for (uint8_t i = 0; i < 3; i++) {
+        controllers[i]->resetAllEncoders();
+      }
+      link.sendAck(HT_ACK_OK);
+      break;
+      
+    case HT_MSG_TELEMETRY_REQUEST:
+      sendTelemetry();
+      break;
+      
+    default:
+      link.sendAck(HT_ACK_UNKNOWN);
+      break;
+  }
+}
+
+void sendTelemetry() {
+  HiTechnicMotorTelemetry telemetry;
+  
+  // One snapshot read per controller (3 transactions for 6 encoders)
+  for (uint8_t i = 0; i < 3; i++) {
+    controllers[i]->readState();
+    telemetry.powers[i * 2] = controllers[i]->getCurrentPower(MOTOR_1);
+    telemetry.powers[i * 2 + 1] = controllers[i]->getCurrentPower(MOTOR_2);
+    telemetry.encoders[i * 2] = controllers[i]->getEncoder(MOTOR_1);
+    telemetry.encoders[i * 2 + 1] = controllers[i]->getEncoder(MOTOR_2);
+  }
+  telemetry.status = 0;
+  telemetry.batteryVoltage = 0;  // Not measured
+  
+  telemetryStream.send(telemetry);
+}
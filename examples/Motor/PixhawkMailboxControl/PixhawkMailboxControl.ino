@@ -0,0 +1,164 @@
+/*
+  PixhawkMailboxControl - Binary commands parsed in an interrupt
+
+  Like PixhawkBinaryControl, but HiTechnicProtocol frames are assembled in
+  a 1 kHz timer interrupt instead of loop(), so a command is decoded
+  within a millisecond of arriving however long the I2C work in loop()
+  takes. The interrupt posts each motor's power to a HiTechnicMailbox and
+  the control tick in loop() takes the latest one per motor: if several
+  commands arrived during a long tick, only the newest is applied.
+
+  HardwareSerial already owns the USART receive interrupt, so the timer
+  interrupt drains Serial1's receive buffer instead. It piggybacks on
+  Timer0 (which runs millis()) through its unused compare A interrupt, so
+  no timer is taken away from the sketch.
+
+  Hardware Setup:
+  - Arduino Mega 2560
+  - Pixhawk TELEM2 → Arduino Serial1 (pins 18/19)
+  - 3x HiTechnic TETRIX Motor Controllers at addresses 0x01, 0x02, 0x03
+  - 10kΩ resistor from Pin 22 to first controller Pin 5
+  - I2C: Pin 20 (SDA), Pin 21 (SCL)
+
+  Messages (see HiTechnicProtocol.h):
+    HT_MSG_MOTOR_COMMAND  - mask + six powers; the newest command is acknowledged
+    HT_MSG_STOP           - emergency stop
+    HT_MSG_RESET_ENCODERS - reset all encoders
+*/
+
+#include <HiTechnicMotor.h>
+#include <HiTechnicChain.h>
+#include <HiTechnicProtocol.h>
+#include <HiTechnicMailbox.h>
+
+#define PIXHAWK_SERIAL Serial1
+#define PIXHAWK_BAUD 57600
+
+#define COMMAND_TIMEOUT 1000     // Stop motors if no command for 1 second
+#define MAX_MOTOR_POWER 100
+#define TELEMETRY_RATE 40        // ms (25 Hz)
+#define ACCEL_RATE 5
+
+// Mailbox channels 0-5 are the motors, channel 6 the last command's
+// id and sequence for the ack
+#define ACK_CHANNEL HT_PROTOCOL_MOTORS
+#define EVENT_STOP 0
+#define EVENT_RESET_ENCODERS 1
+
+HiTechnicMotor controller1(0x01);  // Motors 1 & 2
+HiTechnicMotor controller2(0x02);  // Motors 3 & 4
+HiTechnicMotor controller3(0x03);  // Motors 5 & 6
+HiTechnicMotor* controllers[3] = {&controller1, &controller2, &controller3};
+HiTechnicChain chain;
+
+HiTechnicProtocol link(PIXHAWK_SERIAL);  // parse() only from the interrupt
+HiTechnicMailbox mailbox;
+
+unsigned long lastCommandTime = 0;
+unsigned long lastTelemetryTime = 0;
+
+// Producer: runs every millisecond from Timer0
+ISR(TIMER0_COMPA_vect) {
+  while (PIXHAWK_SERIAL.available()) {
+    if (!link.parse(PIXHAWK_SERIAL.read())) {
+      continue;
+    }
+    switch (link.getMessageId()) {
+      case HT_MSG_MOTOR_COMMAND: {
+        HiTechnicMotorCommand command;
+        if (link.readCommand(command)) {
+          for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+            if (command.motorMask & (1 << i)) {
+              mailbox.post(i, command.powers[i]);
+            }
+          }
+          mailbox.post(ACK_CHANNEL, ((int32_t)link.getMessageId() << 8) | link.getSequence());
+        }
+        break;
+      }
+      case HT_MSG_STOP:
+        mailbox.postEvent(EVENT_STOP);
+        break;
+      case HT_MSG_RESET_ENCODERS:
+        mailbox.postEvent(EVENT_RESET_ENCODERS);
+        break;
+    }
+  }
+}
+
+void setup() {
+  PIXHAWK_SERIAL.begin(PIXHAWK_BAUD);
+
+  pinMode(22, OUTPUT);
+  digitalWrite(22, HIGH);  // Analog detection for the daisy chain
+
+  chain.addMotor(controller1);
+  chain.addMotor(controller2);
+  chain.addMotor(controller3);
+  chain.begin();
+
+  // Timer0 overflows every 1.024 ms; a compare match halfway through
+  // gives a second interrupt at the same rate
+  OCR0A = 0x80;
+  TIMSK0 |= _BV(OCIE0A);
+
+  lastCommandTime = millis();
+}
+
+void loop() {
+  // Consumer: apply the newest setpoint of every motor
+  int32_t value;
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    if (mailbox.take(i, value)) {
+      int8_t power = constrain(value, -MAX_MOTOR_POWER, MAX_MOTOR_POWER);
+      controllers[i / 2]->setMotorPowerSmooth((i % 2) ? MOTOR_2 : MOTOR_1, power, ACCEL_RATE);
+      lastCommandTime = millis();
+    }
+  }
+  if (mailbox.takeEvent(EVENT_STOP)) {
+    chain.stopAll();
+    lastCommandTime = millis();
+  }
+  if (mailbox.takeEvent(EVENT_RESET_ENCODERS)) {
+    for (uint8_t i = 0; i < 3; i++) {
+      controllers[i]->resetAllEncoders();
+    }
+    lastCommandTime = millis();
+  }
+
+  // One ack for the newest command, however many were coalesced
+  if (mailbox.take(ACK_CHANNEL, value)) {
+    uint8_t ack[3] = {(uint8_t)(value >> 8), (uint8_t)value, HT_ACK_OK};
+    link.sendFrame(HT_MSG_ACK, ack, 3);
+  }
+
+  // Watchdog
+  if (millis() - lastCommandTime > COMMAND_TIMEOUT) {
+    chain.stopAll();
+    lastCommandTime = millis();
+  }
+
+  chain.update();
+
+  if (millis() - lastTelemetryTime >= TELEMETRY_RATE) {
+    sendTelemetry();
+    lastTelemetryTime = millis();
+  }
+}
+
+void sendTelemetry() {
+  HiTechnicMotorTelemetry telemetry;
+
+  // One snapshot read per controller (3 transactions for 6 encoders)
+  for (uint8_t i = 0; i < 3; i++) {
+    controllers[i]->readState();
+    telemetry.powers[i * 2] = controllers[i]->getCurrentPower(MOTOR_1);
+    telemetry.powers[i * 2 + 1] = controllers[i]->getCurrentPower(MOTOR_2);
+    telemetry.encoders[i * 2] = controllers[i]->getEncoder(MOTOR_1);
+    telemetry.encoders[i * 2 + 1] = controllers[i]->getEncoder(MOTOR_2);
+  }
+  telemetry.status = 0;
+  telemetry.batteryVoltage = 0;  // Not measured
+
+  link.sendTelemetry(telemetry);
+}
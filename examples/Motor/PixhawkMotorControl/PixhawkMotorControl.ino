@@ -31,6 +31,7 @@
 */
 
 #include <HiTechnicMotor.h>
+#include <HiTechnicSerialScheduler.h>
 
 // Serial configuration
 #define PIXHAWK_SERIAL Serial1  // TELEM2 on Pixhawk
@@ -49,6 +50,11 @@ HiTechnicMotor controller1(0x01);  // Motors 1 & 2
 HiTechnicMotor controller2(0x02);  // Motors 3 & 4
 HiTechnicMotor controller3(0x03);  // Motors 5 & 6
 
+// Queued, non-blocking output: acks before telemetry on the Pixhawk
+// link; debug text is dropped rather than stalling loop()
+HiTechnicSerialScheduler pixhawkOut(PIXHAWK_SERIAL);
+HiTechnicSerialScheduler debugOut(DEBUG_SERIAL);
+
 // Command buffer
 char cmdBuffer[64];
 uint8_t cmdIndex = 0;
@@ -94,10 +100,17 @@ void setup() {
   DEBUG_SERIAL.println(F("\nWaiting for commands from Pixhawk..."));
   DEBUG_SERIAL.println(F("Send 'M1:50' to test motor 1 at 50% power"));
   
+  pixhawkOut.setCapacity(64, 192, 0);
+  debugOut.setCapacity(0, 0, HT_TX_BUFFER_SIZE);
+  
   lastCommandTime = millis();
 }
 
 void loop() {
+  // Hand queued output to the serial ports as their buffers drain
+  pixhawkOut.update();
+  debugOut.update();
+  
   // Check for commands from Pixhawk
   while (PIXHAWK_SERIAL.available()) {
     char c = PIXHAWK_SERIAL.read();
@@ -133,9 +146,10 @@ void loop() {
 
 void processCommand(const char* cmd) {
   lastCommandTime = millis();  // Reset watchdog timer
+  pixhawkOut.setPriority(HT_TX_ACK);
   
-  DEBUG_SERIAL.print(F("CMD: "));
-  DEBUG_SERIAL.println(cmd);
+  debugOut.print(F("CMD: "));
+  debugOut.println(cmd);
   
   // Parse motor commands (M1-M6)
   if (cmd[0] == 'M' && cmd[1] >= '1' && cmd[1] <= '6' && cmd[2] == ':') {
@@ -147,16 +161,16 @@ void processCommand(const char* cmd) {
     
     setMotorPower(motorNum, power);
     
-    PIXHAWK_SERIAL.print(F("OK,M"));
-    PIXHAWK_SERIAL.print(motorNum);
-    PIXHAWK_SERIAL.print(F(":"));
-    PIXHAWK_SERIAL.println(power);
+    pixhawkOut.print(F("OK,M"));
+    pixhawkOut.print(motorNum);
+    pixhawkOut.print(F(":"));
+    pixhawkOut.println(power);
     
   // Emergency stop
   } else if (strcmp(cmd, "STOP") == 0) {
     emergencyStop();
-    PIXHAWK_SERIAL.println(F("STOPPED"));
-    DEBUG_SERIAL.println(F("EMERGENCY STOP"));
+    pixhawkOut.println(F("STOPPED"));
+    debugOut.println(F("EMERGENCY STOP"));
     
   // Status request
   } else if (strcmp(cmd, "STATUS") == 0) {
@@ -167,8 +181,8 @@ void processCommand(const char* cmd) {
     controller1.resetAllEncoders();
     controller2.resetAllEncoders();
     controller3.resetAllEncoders();
-    PIXHAWK_SERIAL.println(F("ENCODERS_RESET"));
-    DEBUG_SERIAL.println(F("Encoders reset"));
+    pixhawkOut.println(F("ENCODERS_RESET"));
+    debugOut.println(F("Encoders reset"));
     
   // Set all motors to same power
   } else if (strncmp(cmd, "MALL:", 5) == 0) {
@@ -179,15 +193,15 @@ void processCommand(const char* cmd) {
       setMotorPower(i, power);
     }
     
-    PIXHAWK_SERIAL.print(F("OK,MALL:"));
-    PIXHAWK_SERIAL.println(power);
+    pixhawkOut.print(F("OK,MALL:"));
+    pixhawkOut.println(power);
     
   // Unknown command
   } else {
-    PIXHAWK_SERIAL.print(F("ERROR,UNKNOWN:"));
-    PIXHAWK_SERIAL.println(cmd);
-    DEBUG_SERIAL.print(F("Unknown command: "));
-    DEBUG_SERIAL.println(cmd);
+    pixhawkOut.print(F("ERROR,UNKNOWN:"));
+    pixhawkOut.println(cmd);
+    debugOut.print(F("Unknown command: "));
+    debugOut.println(cmd);
   }
 }
 
@@ -220,11 +234,11 @@ void setMotorPower(uint8_t motorNum, int8_t power) {
       break;
   }
   
-  DEBUG_SERIAL.print(F("Motor "));
-  DEBUG_SERIAL.print(motorNum);
-  DEBUG_SERIAL.print(F(" → "));
-  DEBUG_SERIAL.print(power);
-  DEBUG_SERIAL.println(F("%"));
+  debugOut.print(F("Motor "));
+  debugOut.print(motorNum);
+  debugOut.print(F(" → "));
+  debugOut.print(power);
+  debugOut.println(F("%"));
 }
 
 void emergencyStop() {
@@ -238,41 +252,48 @@ void emergencyStop() {
 }
 
 void sendTelemetry() {
+  pixhawkOut.setPriority(HT_TX_TELEMETRY);
+  
+  // One snapshot read per controller (3 transactions for 6 encoders)
+  controller1.readState();
+  controller2.readState();
+  controller3.readState();
+  
   // Format: TELEM,P1:val,E1:val,P2:val,E2:val,...
-  PIXHAWK_SERIAL.print(F("TELEM"));
+  pixhawkOut.print(F("TELEM"));
   
   // Controller 1 (Motors 1 & 2)
-  PIXHAWK_SERIAL.print(F(",P1:"));
-  PIXHAWK_SERIAL.print(controller1.getCurrentPower(MOTOR_1));
-  PIXHAWK_SERIAL.print(F(",E1:"));
-  PIXHAWK_SERIAL.print(controller1.readEncoder(MOTOR_1));
+  pixhawkOut.print(F(",P1:"));
+  pixhawkOut.print(controller1.getCurrentPower(MOTOR_1));
+  pixhawkOut.print(F(",E1:"));
+  pixhawkOut.print(controller1.getEncoder(MOTOR_1));
   
-  PIXHAWK_SERIAL.print(F(",P2:"));
-  PIXHAWK_SERIAL.print(controller1.getCurrentPower(MOTOR_2));
-  PIXHAWK_SERIAL.print(F(",E2:"));
-  PIXHAWK_SERIAL.print(controller1.readEncoder(MOTOR_2));
+  pixhawkOut.print(F(",P2:"));
+  pixhawkOut.print(controller1.getCurrentPower(MOTOR_2));
+  pixhawkOut.print(F(",E2:"));
+  pixhawkOut.print(controller1.getEncoder(MOTOR_2));
   
   // Controller 2 (Motors 3 & 4)
-  PIXHAWK_SERIAL.print(F(",P3:"));
-  PIXHAWK_SERIAL.print(controller2.getCurrentPower(MOTOR_1));
-  PIXHAWK_SERIAL.print(F(",E3:"));
-  PIXHAWK_SERIAL.print(controller2.readEncoder(MOTOR_1));
+  pixhawkOut.print(F(",P3:"));
+  pixhawkOut.print(controller2.getCurrentPower(MOTOR_1));
+  pixhawkOut.print(F(",E3:"));
+  pixhawkOut.print(controller2.getEncoder(MOTOR_1));
   
-  PIXHAWK_SERIAL.print(F(",P4:"));
-  PIXHAWK_SERIAL.print(controller2.getCurrentPower(MOTOR_2));
-  PIXHAWK_SERIAL.print(F(",E4:"));
-  PIXHAWK_SERIAL.print(controller2.readEncoder(MOTOR_2));
+  pixhawkOut.print(F(",P4:"));
+  pixhawkOut.print(controller2.getCurrentPower(MOTOR_2));
+  pixhawkOut.print(F(",E4:"));
+  pixhawkOut.print(controller2.getEncoder(MOTOR_2));
   
   // Controller 3 (Motors 5 & 6)
-  PIXHAWK_SERIAL.print(F(",P5:"));
-  PIXHAWK_SERIAL.print(controller3.getCurrentPower(MOTOR_1));
-  PIXHAWK_SERIAL.print(F(",E5:"));
-  PIXHAWK_SERIAL.print(controller3.readEncoder(MOTOR_1));
+  pixhawkOut.print(F(",P5:"));
+  pixhawkOut.print(controller3.getCurrentPower(MOTOR_1));
+  pixhawkOut.print(F(",E5:"));
+  pixhawkOut.print(controller3.getEncoder(MOTOR_1));
   
-  PIXHAWK_SERIAL.print(F(",P6:"));
-  PIXHAWK_SERIAL.print(controller3.getCurrentPower(MOTOR_2));
-  PIXHAWK_SERIAL.print(F(",E6:"));
-  PIXHAWK_SERIAL.println(controller3.readEncoder(MOTOR_2));
+  pixhawkOut.print(F(",P6:"));
+  pixhawkOut.print(controller3.getCurrentPower(MOTOR_2));
+  pixhawkOut.print(F(",E6:"));
+  pixhawkOut.println(controller3.getEncoder(MOTOR_2));
 }
 
 // Test function - can be called from DEBUG_SERIAL
@@ -21,6 +21,7 @@
 */
 
 #include "HiTechnicMotor.h"
+#include "HiTechnicChain.h"
 
 // Pin 22 provides 5V for analog detection (through 10kΩ resistor to Pin 5 of first controller)
 #define ANALOG_DETECT_PIN 22
@@ -30,6 +31,9 @@ HiTechnicMotor controller1(0x01);
 HiTechnicMotor controller2(0x02);
 HiTechnicMotor controller3(0x03);
 
+// Owns the three controllers and services them from one update()
+HiTechnicChain chain;
+
 void setup() {
   Serial.begin(115200);
   Serial.println("=== Smooth Six Motors Demo ===");
@@ -40,9 +44,10 @@ void setup() {
   delay(100);
   
   // Initialize all motor controllers
-  controller1.begin();
-  controller2.begin();
-  controller3.begin();
+  chain.addMotor(controller1);
+  chain.addMotor(controller2);
+  chain.addMotor(controller3);
+  chain.begin();
   delay(200);
   
   // Set acceleration rate for all controllers (1 = 2 second ramp to 100%)
@@ -61,10 +66,8 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, 70);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, 70);
   
-  // Update all controllers until ramping complete
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  // One update() steps every ramp and writes all three controllers
+  while (chain.update()) { }
   Serial.println("All motors at 70%");
   delay(2000);
   
@@ -74,9 +77,7 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, 0);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, 0);
   
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  while (chain.update()) { }
   Serial.println("All motors stopped");
   delay(2000);
   
@@ -85,32 +86,32 @@ void loop() {
   
   Serial.println("  C1M1 starting...");
   controller1.setMotorPowerSmooth(MOTOR_1, 60);
-  while (controller1.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   Serial.println("  C1M2 starting...");
   controller1.setMotorPowerSmooth(MOTOR_2, 60);
-  while (controller1.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   Serial.println("  C2M1 starting...");
   controller2.setMotorPowerSmooth(MOTOR_1, 60);
-  while (controller2.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   Serial.println("  C2M2 starting...");
   controller2.setMotorPowerSmooth(MOTOR_2, 60);
-  while (controller2.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   Serial.println("  C3M1 starting...");
   controller3.setMotorPowerSmooth(MOTOR_1, 60);
-  while (controller3.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   Serial.println("  C3M2 starting...");
   controller3.setMotorPowerSmooth(MOTOR_2, 60);
-  while (controller3.update()) { delay(20); }
+  while (chain.update()) { }
   
   Serial.println("All motors at 60%");
   delay(2000);
@@ -119,27 +120,27 @@ void loop() {
   Serial.println("Pattern 4: Wave pattern shutdown");
   
   controller3.setMotorPowerSmooth(MOTOR_2, 0);
-  while (controller3.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   controller3.setMotorPowerSmooth(MOTOR_1, 0);
-  while (controller3.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   controller2.setMotorPowerSmooth(MOTOR_2, 0);
-  while (controller2.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   controller2.setMotorPowerSmooth(MOTOR_1, 0);
-  while (controller2.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   controller1.setMotorPowerSmooth(MOTOR_2, 0);
-  while (controller1.update()) { delay(20); }
+  while (chain.update()) { }
   delay(300);
   
   controller1.setMotorPowerSmooth(MOTOR_1, 0);
-  while (controller1.update()) { delay(20); }
+  while (chain.update()) { }
   
   Serial.println("All motors stopped");
   delay(2000);
@@ -153,9 +154,7 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, 70);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, 100);
   
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  while (chain.update()) { }
   delay(2000);
   
   // Swap speeds smoothly
@@ -164,9 +163,7 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, 40);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, 70);
   
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  while (chain.update()) { }
   delay(2000);
   
   // All to medium speed
@@ -175,9 +172,7 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, 50);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, 50);
   
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  while (chain.update()) { }
   delay(2000);
   
   // Stop all
@@ -186,9 +181,7 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, 0);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, 0);
   
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  while (chain.update()) { }
   Serial.println("All motors stopped");
   delay(2000);
   
@@ -200,9 +193,7 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, 60);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, -60);
   
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  while (chain.update()) { }
   delay(2000);
   
   Serial.println("  Reversing directions...");
@@ -210,9 +201,7 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, -60);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, 60);
   
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  while (chain.update()) { }
   delay(2000);
   
   Serial.println("  Smooth stop...");
@@ -220,9 +209,7 @@ void loop() {
   controller2.setMotorPowerSmooth(MOTOR_BOTH, 0);
   controller3.setMotorPowerSmooth(MOTOR_BOTH, 0);
   
-  while (controller1.update() | controller2.update() | controller3.update()) {
-    delay(20);
-  }
+  while (chain.update()) { }
   Serial.println("All motors stopped");
   
   Serial.println("\n=== All patterns complete! Restarting... ===\n");
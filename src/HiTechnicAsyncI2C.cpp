@@ -0,0 +1,385 @@
+/*
+  HiTechnicAsyncI2C.cpp - Queued, non-blocking I2C register transactions
+  for HiTechnic TETRIX controllers
+*/
+
+#include "HiTechnicAsyncI2C.h"
+
+#if defined(__AVR__) && defined(TWCR)
+#include <util/twi.h>
+#define HT_ASYNC_AVR_TWI 1
+
+#ifdef HT_ASYNC_I2C_ISR
+// TWCR bits kept set while the engine owns the bus (TWI_vect steps it)
+#define HT_TWCR_BASE (_BV(TWEN) | _BV(TWIE))
+
+// TWCR value while the queue is empty: no interrupt, no slave address
+#define HT_TWCR_IDLE _BV(TWEN)
+
+// Main-context sections that share state with TWI_vect
+#define HT_ASYNC_LOCK()   uint8_t oldSREG = SREG; cli()
+#define HT_ASYNC_UNLOCK() SREG = oldSREG
+#else
+// TWCR bits kept set while the engine owns the bus (no TWIE: Wire keeps
+// its interrupt handler and the engine is stepped from poll())
+#define HT_TWCR_BASE _BV(TWEN)
+
+// TWCR value Wire expects when the bus is idle
+#define HT_TWCR_IDLE (_BV(TWEN) | _BV(TWIE) | _BV(TWEA))
+#endif
+
+#else
+#define HT_ASYNC_AVR_TWI 0
+
+#ifdef HT_ASYNC_I2C_ISR
+#error "HT_ASYNC_I2C_ISR needs the AVR TWI hardware"
+#endif
+#endif
+
+#ifndef HT_ASYNC_LOCK
+#define HT_ASYNC_LOCK()
+#define HT_ASYNC_UNLOCK()
+#endif
+
+HiTechnicAsyncI2C HTAsyncI2C;
+
+#if HT_ASYNC_AVR_TWI && defined(HT_ASYNC_I2C_ISR)
+ISR(TWI_vect) {
+  HTAsyncI2C.handleEvent();
+}
+#endif
+
+// Initialize the bus
+void HiTechnicAsyncI2C::begin(uint32_t clock) {
+  _head = 0;
+  _tail = 0;
+  _done = 0;
+  _busy = false;
+  for (uint8_t i = 0; i < HT_ASYNC_GAP_SLOTS; i++) {
+    _gapAddress[i] = 0;
+  }
+
+#if HT_ASYNC_AVR_TWI && defined(HT_ASYNC_I2C_ISR)
+  // Same setup as Wire.begin(): internal pull-ups, prescaler 1
+  digitalWrite(SDA, HIGH);
+  digitalWrite(SCL, HIGH);
+  TWSR &= ~(_BV(TWPS0) | _BV(TWPS1));
+  TWBR = ((F_CPU / clock) - 16) / 2;
+  TWCR = HT_TWCR_IDLE;
+#else
+  Wire.begin();
+  Wire.setClock(clock);
+#endif
+}
+
+// Queue a register write
+bool HiTechnicAsyncI2C::write(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length,
+                              HiTechnicAsyncCallback callback, void* context,
+                              volatile uint8_t* status) {
+  if (length > HT_ASYNC_MAX_WRITE) {
+    return false;
+  }
+  return enqueue(address, reg, false, NULL, data, length, callback, context, status);
+}
+
+// Queue a register read
+bool HiTechnicAsyncI2C::read(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length,
+                             HiTechnicAsyncCallback callback, void* context,
+                             volatile uint8_t* status) {
+  if (length == 0 || buffer == NULL) {
+    return false;
+  }
+  return enqueue(address, reg, true, buffer, NULL, length, callback, context, status);
+}
+
+// Fill the next free slot and start the engine if it is idle
+bool HiTechnicAsyncI2C::enqueue(uint8_t address, uint8_t reg, bool read, uint8_t* buffer,
+                                const uint8_t* data, uint8_t length,
+                                HiTechnicAsyncCallback callback, void* context,
+                                volatile uint8_t* status) {
+  uint8_t next = (_head + 1) % HT_ASYNC_QUEUE_SIZE;
+  if (next == _done) {
+    return false;  // Queue full
+  }
+
+  HiTechnicAsyncRequest& req = _queue[_head];
+  req.address = address;
+  req.reg = reg;
+  req.length = length;
+  req.read = read;
+  req.buffer = buffer;
+  if (!read) {
+    for (uint8_t i = 0; i < length; i++) {
+      req.data[i] = data[i];
+    }
+  }
+  req.callback = callback;
+  req.context = context;
+  req.status = status;
+  req.result = HT_ASYNC_PENDING;
+  if (status != NULL) {
+    *status = HT_ASYNC_PENDING;
+  }
+
+  // Publish the slot only once it is completely filled in
+  HT_ASYNC_LOCK();
+  _head = next;
+#if HT_ASYNC_AVR_TWI
+  if (!_busy) {
+    startNext();
+  }
+#endif
+  HT_ASYNC_UNLOCK();
+
+  return true;
+}
+
+// Step the bus without waiting on it, then deliver finished transactions
+void HiTechnicAsyncI2C::poll() {
+#if HT_ASYNC_AVR_TWI
+  HT_ASYNC_LOCK();
+  if (!_busy) {
+    startNext();  // The head may have been held for its write gap
+  }
+#ifndef HT_ASYNC_I2C_ISR
+  // Every ready event, stopping as soon as the hardware is busy with a byte
+  while (_busy && (TWCR & _BV(TWINT))) {
+    handleEvent();
+  }
+#endif
+  HT_ASYNC_UNLOCK();
+#else
+  // No TWI hardware access: run one queued transaction through Wire
+  if (canStart()) {
+    _busy = true;
+    HiTechnicAsyncRequest& req = _queue[_tail];
+
+    Wire.beginTransmission(req.address);
+    Wire.write(req.reg);
+    if (!req.read) {
+      Wire.write(req.data, req.length);
+    }
+    uint8_t status = Wire.endTransmission(!req.read);
+
+    if (status == HT_ASYNC_OK && req.read) {
+      uint8_t received = Wire.requestFrom(req.address, req.length);
+      for (uint8_t i = 0; i < received; i++) {
+        req.buffer[i] = Wire.read();
+      }
+      if (received < req.length) {
+        status = HT_ASYNC_ERROR;
+      }
+    }
+
+    complete(status);
+  }
+#endif
+
+  deliver();
+}
+
+// Block until every queued transaction has completed
+void HiTechnicAsyncI2C::waitIdle() {
+  while (!isIdle()) {
+    poll();
+    yield();
+  }
+}
+
+// Check if no transaction is queued, in flight or waiting for delivery
+bool HiTechnicAsyncI2C::isIdle() {
+  return _done == _head;
+}
+
+// Number of queued transactions not yet delivered
+uint8_t HiTechnicAsyncI2C::pending() {
+  return (uint8_t)(_head - _done + HT_ASYNC_QUEUE_SIZE) % HT_ASYNC_QUEUE_SIZE;
+}
+
+// Check if the transaction at the tail of the queue may go on the bus
+bool HiTechnicAsyncI2C::canStart() {
+  return _tail != _head && !isHeld(_queue[_tail]);
+}
+
+// Begin the transaction at the tail of the queue unless the queue is
+// empty or its head waits out a write gap
+void HiTechnicAsyncI2C::startNext() {
+#if HT_ASYNC_AVR_TWI
+  if (!canStart()) {
+    return;
+  }
+
+  // A STOP issued without waiting may still be on the wire (one bit time)
+  while (TWCR & _BV(TWSTO)) {
+  }
+
+  _busy = true;
+  _index = 0;
+  _readPhase = false;
+  TWCR = HT_TWCR_BASE | _BV(TWINT) | _BV(TWSTA);
+#endif
+}
+
+// Advance the state machine by one TWI event
+void HiTechnicAsyncI2C::handleEvent() {
+#if HT_ASYNC_AVR_TWI
+  if (!_busy) {
+#ifdef HT_ASYNC_I2C_ISR
+    TWCR = HT_TWCR_IDLE;  // Stray event: mask the interrupt
+#endif
+    return;
+  }
+
+  HiTechnicAsyncRequest& req = _queue[_tail];
+
+  switch (TW_STATUS) {
+    // START sent: address the device, read bit set once the pointer is written
+    case TW_START:
+    case TW_REP_START:
+      TWDR = (req.address << 1) | (_readPhase ? TW_READ : TW_WRITE);
+      TWCR = HT_TWCR_BASE | _BV(TWINT);
+      break;
+
+    // Device acknowledged: send the register pointer
+    case TW_MT_SLA_ACK:
+      TWDR = req.reg;
+      TWCR = HT_TWCR_BASE | _BV(TWINT);
+      break;
+
+    // Byte acknowledged: next payload byte, repeated START for reads, or done
+    case TW_MT_DATA_ACK:
+      if (req.read) {
+        _readPhase = true;
+        TWCR = HT_TWCR_BASE | _BV(TWINT) | _BV(TWSTA);
+      } else if (_index < req.length) {
+        TWDR = req.data[_index++];
+        TWCR = HT_TWCR_BASE | _BV(TWINT);
+      } else {
+        complete(HT_ASYNC_OK);
+      }
+      break;
+
+    // Read addressed: ACK every byte but the last
+    case TW_MR_SLA_ACK:
+      TWCR = HT_TWCR_BASE | _BV(TWINT) | (req.length > 1 ? _BV(TWEA) : 0);
+      break;
+
+    case TW_MR_DATA_ACK:
+      req.buffer[_index++] = TWDR;
+      TWCR = HT_TWCR_BASE | _BV(TWINT) | (_index + 1 < req.length ? _BV(TWEA) : 0);
+      break;
+
+    case TW_MR_DATA_NACK:
+      req.buffer[_index++] = TWDR;
+      complete(HT_ASYNC_OK);
+      break;
+
+    case TW_MT_SLA_NACK:
+    case TW_MR_SLA_NACK:
+      complete(HT_ASYNC_NACK_ADDRESS);
+      break;
+
+    case TW_MT_DATA_NACK:
+      complete(HT_ASYNC_NACK_DATA);
+      break;
+
+    // Arbitration lost or bus error
+    default:
+      complete(HT_ASYNC_ERROR);
+      break;
+  }
+#endif
+}
+
+// Finish the transaction on the bus and start the next one. Runs in
+// TWI_vect with HT_ASYNC_I2C_ISR, so the result is only recorded here and
+// handed to the caller by deliver().
+void HiTechnicAsyncI2C::complete(uint8_t status) {
+  HiTechnicAsyncRequest& req = _queue[_tail];
+  req.result = status;
+  if (!req.read) {
+    recordWrite(req.address);
+  }
+  _tail = (_tail + 1) % HT_ASYNC_QUEUE_SIZE;
+  _busy = false;
+
+#if HT_ASYNC_AVR_TWI
+  if (TW_STATUS == TW_MT_ARB_LOST) {
+    // Another master owns the bus: release without a STOP
+    TWCR = HT_TWCR_BASE | _BV(TWINT);
+    startNext();
+  } else if (canStart()) {
+    // STOP followed directly by the START of the next transaction
+    _busy = true;
+    _index = 0;
+    _readPhase = false;
+    TWCR = HT_TWCR_BASE | _BV(TWINT) | _BV(TWSTO) | _BV(TWSTA);
+    return;
+  } else {
+    // STOP completes within a bit time and raises no interrupt
+    TWCR = HT_TWCR_BASE | _BV(TWINT) | _BV(TWSTO);
+  }
+
+#ifndef HT_ASYNC_I2C_ISR
+  if (!_busy) {
+    // Hand the hardware back to Wire once the STOP is out
+    while (TWCR & _BV(TWSTO)) {
+    }
+    TWCR = HT_TWCR_IDLE;
+  }
+#endif
+#endif
+}
+
+// Report finished transactions in queue order: status flag, then callback
+void HiTechnicAsyncI2C::deliver() {
+  HT_ASYNC_LOCK();
+  uint8_t tail = _tail;
+  HT_ASYNC_UNLOCK();
+
+  while (_done != tail) {
+    HiTechnicAsyncRequest& req = _queue[_done];
+    HiTechnicAsyncCallback callback = req.callback;
+    void* context = req.context;
+    uint8_t status = req.result;
+    if (req.status != NULL) {
+      *req.status = status;
+    }
+
+    // Free the slot before the callback so it can queue follow-up work
+    _done = (_done + 1) % HT_ASYNC_QUEUE_SIZE;
+
+    if (callback != NULL) {
+      callback(context, status);
+    }
+  }
+}
+
+// Check if req has to wait: its address is still in the gap after a
+// write, or it is a write and every gap entry is taken
+bool HiTechnicAsyncI2C::isHeld(const HiTechnicAsyncRequest& req) {
+  bool free = false;
+  for (uint8_t i = 0; i < HT_ASYNC_GAP_SLOTS; i++) {
+    if (_gapAddress[i] != 0 && micros() - _gapStart[i] >= HT_I2C_WRITE_GAP_US) {
+      _gapAddress[i] = 0;  // Expired
+    }
+    if (_gapAddress[i] == req.address) {
+      return true;
+    }
+    if (_gapAddress[i] == 0) {
+      free = true;
+    }
+  }
+  return !free && !req.read;
+}
+
+// Start the gap of a completed write (isHeld() made room for it)
+void HiTechnicAsyncI2C::recordWrite(uint8_t address) {
+  for (uint8_t i = 0; i < HT_ASYNC_GAP_SLOTS; i++) {
+    if (_gapAddress[i] == 0) {
+      _gapAddress[i] = address;
+      _gapStart[i] = micros();
+      return;
+    }
+  }
+}
@@ -0,0 +1,157 @@
+/*
+  HiTechnicAsyncI2C.h - Queued, non-blocking I2C register transactions
+  for HiTechnic TETRIX controllers
+
+  Callers enqueue register reads and writes into a fixed-size ring, which
+  the AVR TWI hardware works through one transaction at a time. The
+  engine runs in one of two modes:
+
+  - Polled (default): the engine is stepped from poll(), which handles
+    every TWI event that is ready and returns as soon as the hardware is
+    busy with a byte. TWI interrupts stay off while the engine owns the
+    bus, so it shares the hardware with the Wire library (and its
+    interrupt handler). A transaction only moves on while poll() is being
+    called, so this is non-blocking I/O, not background I/O.
+
+  - Interrupt driven (HT_ASYNC_I2C_ISR): the engine owns the TWI interrupt
+    and works through the queue in the background while loop() does other
+    work. Wire defines the same interrupt handler, so the sketch must not
+    use Wire, directly or through another library; the default HTWireBus
+    then runs the blocking driver calls through this engine. The flag has
+    to reach the library sources, so set it as a compiler flag
+    (-DHT_ASYNC_I2C_ISR, e.g. in PlatformIO build_flags), not with a
+    #define in the sketch.
+
+  In both modes, callbacks and status flags are delivered from poll() in
+  queue order, so callbacks never run in interrupt context. They must not
+  make blocking driver calls.
+
+  Like the blocking drivers, the engine waits HT_I2C_WRITE_GAP_US after a
+  write completes before it starts the next transaction to the same
+  address; a transaction held back this way also holds the ones queued
+  behind it, and is started by the next poll() or enqueued request once
+  its gap is over. Blocking driver calls on the default bus drain the
+  queue first (waitIdle()), so the two never overlap on the bus.
+
+  On boards without the AVR TWI, poll() runs one queued transaction per
+  call through Wire.
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicAsyncI2C_h
+#define HiTechnicAsyncI2C_h
+
+#include "Arduino.h"
+#ifndef HT_ASYNC_I2C_ISR
+#include <Wire.h>
+#endif
+#include "HiTechnicBus.h"
+
+#if defined(HT_ASYNC_I2C_ISR) && defined(TwoWire_h)
+#error "HT_ASYNC_I2C_ISR replaces Wire's TWI interrupt: do not include Wire.h"
+#endif
+
+// Number of queued transactions (one slot is kept free)
+#ifndef HT_ASYNC_QUEUE_SIZE
+#define HT_ASYNC_QUEUE_SIZE   8
+#endif
+
+// Writes whose gap can run at once; a further write waits for one to end
+#ifndef HT_ASYNC_GAP_SLOTS
+#define HT_ASYNC_GAP_SLOTS    4
+#endif
+
+// Largest write payload; write data is copied into the queue slot
+#define HT_ASYNC_MAX_WRITE    12
+
+// Transaction status (same codes as Wire.endTransmission())
+#define HT_ASYNC_OK           0
+#define HT_ASYNC_NACK_ADDRESS 2
+#define HT_ASYNC_NACK_DATA    3
+#define HT_ASYNC_ERROR        4
+#define HT_ASYNC_PENDING      0xFF
+
+// Completion callback: context is passed through unchanged
+typedef void (*HiTechnicAsyncCallback)(void* context, uint8_t status);
+
+// One queued register transaction
+struct HiTechnicAsyncRequest {
+  uint8_t address;
+  uint8_t reg;
+  uint8_t length;
+  bool read;
+  uint8_t* buffer;                  // Read destination (caller owned)
+  uint8_t data[HT_ASYNC_MAX_WRITE]; // Write payload (copied)
+  HiTechnicAsyncCallback callback;
+  void* context;
+  volatile uint8_t* status;         // Optional completion flag
+  uint8_t result;                   // Status once finished on the bus
+};
+
+class HiTechnicAsyncI2C {
+  public:
+    // Initialize the bus (also initializes Wire unless HT_ASYNC_I2C_ISR)
+    void begin(uint32_t clock = 100000);
+
+    // Queue a register write; data is copied (up to HT_ASYNC_MAX_WRITE bytes)
+    // Returns false if the queue is full or the payload is too long
+    bool write(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length,
+               HiTechnicAsyncCallback callback = NULL, void* context = NULL,
+               volatile uint8_t* status = NULL);
+
+    // Queue a register read into buffer, which must stay valid until completion
+    // Returns false if the queue is full
+    bool read(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length,
+              HiTechnicAsyncCallback callback = NULL, void* context = NULL,
+              volatile uint8_t* status = NULL);
+
+    // Handle every TWI event that is ready (polled mode), start a
+    // transaction that waited out its write gap, and deliver finished
+    // transactions, without waiting on the bus (call often from loop())
+    void poll();
+
+    // Block until every queued transaction has completed
+    void waitIdle();
+
+    // Check if no transaction is queued or in flight
+    bool isIdle();
+
+    // Number of queued transactions, including the one in flight and
+    // finished ones not yet delivered by poll()
+    uint8_t pending();
+
+    // Advance the bus by one TWI event (called by the TWI interrupt or
+    // poll(), not by sketches)
+    void handleEvent();
+
+  private:
+    // All members start zeroed, so the global instance needs no constructor
+    HiTechnicAsyncRequest _queue[HT_ASYNC_QUEUE_SIZE];
+    volatile uint8_t _head;   // Next free slot
+    volatile uint8_t _tail;   // Slot in flight (or next to start)
+    uint8_t _done;            // Oldest finished slot not yet delivered
+    volatile bool _busy;      // Engine owns the bus
+    uint8_t _index;           // Byte position within the transaction
+    bool _readPhase;          // Register pointer sent, reading data
+
+    // Addresses written recently and micros() when each write completed
+    // (address 0 marks a free entry)
+    uint8_t _gapAddress[HT_ASYNC_GAP_SLOTS];
+    unsigned long _gapStart[HT_ASYNC_GAP_SLOTS];
+
+    bool enqueue(uint8_t address, uint8_t reg, bool read, uint8_t* buffer,
+                 const uint8_t* data, uint8_t length,
+                 HiTechnicAsyncCallback callback, void* context,
+                 volatile uint8_t* status);
+    bool canStart();
+    void startNext();
+    void complete(uint8_t status);
+    void deliver();
+    bool isHeld(const HiTechnicAsyncRequest& req);
+    void recordWrite(uint8_t address);
+};
+
+extern HiTechnicAsyncI2C HTAsyncI2C;
+
+#endif
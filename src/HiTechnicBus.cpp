@@ -0,0 +1,152 @@
+/*
+  HiTechnicBus.cpp - I2C bus interface used by the HiTechnic drivers
+*/
+
+#include "HiTechnicBus.h"
+#include "HiTechnicAsyncI2C.h"
+
+#ifndef HT_ASYNC_I2C_ISR
+HiTechnicWireBus HTWireBus(Wire);
+#else
+HiTechnicTwiBus HTWireBus;
+#endif
+
+// Register read as one combined transaction
+uint8_t HiTechnicBus::writeThenRead(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) {
+  beginTransmission(address);
+  write(reg);
+  if (endTransmission(false) != 0) {
+    return 0;
+  }
+  
+  requestFrom(address, length);
+  
+  uint8_t count = 0;
+  while (available() > 0 && count < length) {
+    buffer[count++] = read();
+  }
+  return count;
+}
+
+#ifndef HT_ASYNC_I2C_ISR
+// Constructor
+HiTechnicWireBus::HiTechnicWireBus(TwoWire& wire) {
+  _wire = &wire;
+}
+
+void HiTechnicWireBus::begin() {
+  _wire->begin();
+}
+
+void HiTechnicWireBus::beginTransmission(uint8_t address) {
+  _wire->beginTransmission(address);
+}
+
+size_t HiTechnicWireBus::write(uint8_t data) {
+  return _wire->write(data);
+}
+
+uint8_t HiTechnicWireBus::endTransmission(bool sendStop) {
+  return _wire->endTransmission(sendStop);
+}
+
+uint8_t HiTechnicWireBus::requestFrom(uint8_t address, uint8_t quantity) {
+  return _wire->requestFrom(address, quantity);
+}
+
+int HiTechnicWireBus::available() {
+  return _wire->available();
+}
+
+int HiTechnicWireBus::read() {
+  return _wire->read();
+}
+#else
+// Constructor
+HiTechnicTwiBus::HiTechnicTwiBus() {
+  _address = 0;
+  _length = 0;
+  _index = 0;
+  _pointerHeld = false;
+}
+
+void HiTechnicTwiBus::begin() {
+  HTAsyncI2C.waitIdle();
+  HTAsyncI2C.begin();
+}
+
+void HiTechnicTwiBus::beginTransmission(uint8_t address) {
+  _address = address;
+  _length = 0;
+  _index = 0;
+  _pointerHeld = false;
+}
+
+size_t HiTechnicTwiBus::write(uint8_t data) {
+  if (_length >= HT_TWI_BUS_BUFFER) {
+    return 0;
+  }
+  _buffer[_length++] = data;
+  return 1;
+}
+
+// Queue the buffered write and wait for it. A lone register pointer
+// without a STOP is kept for the requestFrom() that follows.
+uint8_t HiTechnicTwiBus::endTransmission(bool sendStop) {
+  if (_length == 0) {
+    return HT_ASYNC_ERROR;  // Nothing to address a register with
+  }
+  if (!sendStop && _length == 1) {
+    _pointerHeld = true;
+    return HT_ASYNC_OK;
+  }
+
+  volatile uint8_t status;
+  HTAsyncI2C.waitIdle();
+  if (!HTAsyncI2C.write(_address, _buffer[0], _buffer + 1, _length - 1, NULL, NULL, &status)) {
+    return HT_ASYNC_ERROR;  // Payload longer than HT_ASYNC_MAX_WRITE
+  }
+  HTAsyncI2C.waitIdle();
+  _length = 0;
+  return status;
+}
+
+uint8_t HiTechnicTwiBus::requestFrom(uint8_t address, uint8_t quantity) {
+  bool pointerHeld = _pointerHeld && address == _address;
+  uint8_t reg = _buffer[0];
+  _pointerHeld = false;
+  _length = 0;
+  _index = 0;
+  if (!pointerHeld) {
+    return 0;
+  }
+
+  if (quantity > HT_TWI_BUS_BUFFER) {
+    quantity = HT_TWI_BUS_BUFFER;
+  }
+  _length = writeThenRead(address, reg, _buffer, quantity);
+  return _length;
+}
+
+int HiTechnicTwiBus::available() {
+  return _length - _index;
+}
+
+int HiTechnicTwiBus::read() {
+  if (_index >= _length) {
+    return -1;
+  }
+  return _buffer[_index++];
+}
+
+// Register read as one queued repeated-START transaction
+uint8_t HiTechnicTwiBus::writeThenRead(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) {
+  volatile uint8_t status;
+  HTAsyncI2C.waitIdle();
+  if (!HTAsyncI2C.read(address, reg, buffer, length, NULL, NULL, &status)) {
+    return 0;
+  }
+  HTAsyncI2C.waitIdle();
+  return (status == HT_ASYNC_OK) ? length : 0;
+}
+#endif
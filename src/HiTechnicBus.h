@@ -0,0 +1,113 @@
+/*
+  HiTechnicBus.h - I2C bus interface used by the HiTechnic drivers
+
+  HiTechnicMotor and HiTechnicServo talk to their controller through a
+  HiTechnicBus instead of the global Wire object, so the same driver code
+  runs over hardware TWI (HiTechnicWireBus), a bit-banged SoftwareI2C pin
+  pair, or an in-memory HiTechnicMockBus on a host. Builds with
+  HT_ASYNC_I2C_ISR do not link Wire; their hardware TWI bus is a
+  HiTechnicTwiBus on the HTAsyncI2C engine instead.
+
+  The interface mirrors the subset of TwoWire the drivers use.
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicBus_h
+#define HiTechnicBus_h
+
+#include "Arduino.h"
+#ifndef HT_ASYNC_I2C_ISR
+#include <Wire.h>
+#endif
+
+// Minimum gap the controller needs after a write before it is accessed again
+// (microseconds). Only transactions to the same controller wait for it.
+#ifndef HT_I2C_WRITE_GAP_US
+#define HT_I2C_WRITE_GAP_US   1000
+#endif
+
+class HiTechnicBus {
+  public:
+    // Initialize the bus hardware
+    virtual void begin() = 0;
+
+    // Start buffering a write to address
+    virtual void beginTransmission(uint8_t address) = 0;
+
+    // Buffer one byte, returns 1 if it fit
+    virtual size_t write(uint8_t data) = 0;
+
+    // Send the buffered write. With sendStop false the bus is held and the
+    // next transaction begins with a repeated START.
+    // Returns 0 on success, 2 on address NACK, 3 on data NACK, 4 on other error
+    virtual uint8_t endTransmission(bool sendStop = true) = 0;
+
+    // Read quantity bytes from address, returns the number received
+    virtual uint8_t requestFrom(uint8_t address, uint8_t quantity) = 0;
+
+    // Bytes left from the last requestFrom()
+    virtual int available() = 0;
+
+    // Next byte from the last requestFrom(), -1 if none
+    virtual int read() = 0;
+
+    // Write the register pointer, then read length bytes after a repeated
+    // START (no STOP in between). Returns the number of bytes received.
+    virtual uint8_t writeThenRead(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length);
+};
+
+#ifndef HT_ASYNC_I2C_ISR
+// Hardware TWI through a TwoWire instance
+class HiTechnicWireBus : public HiTechnicBus {
+  public:
+    HiTechnicWireBus(TwoWire& wire);
+
+    void begin();
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    int available();
+    int read();
+
+  private:
+    TwoWire* _wire;
+};
+
+// Default bus for the drivers: the global Wire object
+extern HiTechnicWireBus HTWireBus;
+#else
+// Transmit and receive buffer of HiTechnicTwiBus (register pointer included)
+#define HT_TWI_BUS_BUFFER     32
+
+// Hardware TWI through the HTAsyncI2C engine. Each transaction is queued
+// and waited for. Every transfer starts with a register pointer: a
+// requestFrom() needs a one-byte endTransmission(false) to the same
+// address before it, and writes always end with a STOP.
+class HiTechnicTwiBus : public HiTechnicBus {
+  public:
+    HiTechnicTwiBus();
+
+    void begin();
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    int available();
+    int read();
+    uint8_t writeThenRead(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length);
+
+  private:
+    uint8_t _address;
+    uint8_t _buffer[HT_TWI_BUS_BUFFER];
+    uint8_t _length;        // Bytes written, or bytes received
+    uint8_t _index;         // Next byte for read()
+    bool _pointerHeld;      // Register pointer kept for requestFrom()
+};
+
+// Default bus for the drivers: hardware TWI without Wire
+extern HiTechnicTwiBus HTWireBus;
+#endif
+
+#endif
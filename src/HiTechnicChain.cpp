@@ -0,0 +1,209 @@
+/*
+  HiTechnicChain.cpp - Single update() for every HiTechnic controller on a
+  daisy chain
+*/
+
+#include "HiTechnicChain.h"
+
+// Constructor
+HiTechnicChain::HiTechnicChain() : _ticker(HT_CHAIN_TICK_MS) {
+  _motorCount = 0;
+  _servoCount = 0;
+  _moveCount = 0;
+  _nextSlot = 0;
+  _busBudget = HT_CHAIN_BUS_BUDGET_US;
+  _lastBusTime = 0;
+  _backlog = 0;
+}
+
+bool HiTechnicChain::addMotor(HiTechnicMotor& motor) {
+  if (getDeviceCount() >= HT_CHAIN_MAX_DEVICES) {
+    return false;
+  }
+  motor.setAutoFlush(false);
+  _motors[_motorCount++] = &motor;
+  return true;
+}
+
+bool HiTechnicChain::addServo(HiTechnicServo& servo) {
+  if (getDeviceCount() >= HT_CHAIN_MAX_DEVICES) {
+    return false;
+  }
+  servo.setAutoFlush(false);
+  _servos[_servoCount++] = &servo;
+  return true;
+}
+
+bool HiTechnicChain::addMove(HiTechnicMove& move) {
+  if (_moveCount >= HT_CHAIN_MAX_MOVES) {
+    return false;
+  }
+  _moves[_moveCount++] = &move;
+  return true;
+}
+
+// Initialize the controllers (each begin() writes its defaults directly)
+void HiTechnicChain::begin() {
+  for (uint8_t i = 0; i < _motorCount; i++) {
+    _motors[i]->begin();
+  }
+  for (uint8_t i = 0; i < _servoCount; i++) {
+    _servos[i]->begin();
+  }
+  _ticker.begin();
+}
+
+bool HiTechnicChain::update() {
+  uint8_t count = getDeviceCount();
+  
+  // Ramp ticks: all motors step together, writes are only staged. Late
+  // ticks run back to back so the ramp rate stays fixed. The snapshot
+  // reads of speed loops and motion watches count against the budget.
+  unsigned long start = micros();
+  bool ticked = false;
+  while (_ticker.due()) {
+    for (uint8_t i = 0; i < _motorCount; i++) {
+      _motors[i]->stepRamp();
+      _motors[i]->stepSpeed((uint32_t)_ticker.getPeriod() * 1000);
+      _motors[i]->checkMotion();
+    }
+    for (uint8_t i = 0; i < _moveCount; i++) {
+      _moves[i]->step();
+    }
+    ticked = true;
+  }
+  
+  // Round-robin slots: visit each device at most once, stop when the
+  // budget is spent. Devices still in their post-write gap are skipped
+  // rather than waited for.
+  unsigned long spent = micros() - start;
+  uint8_t slot = _nextSlot;
+  uint8_t nextSlot = (_nextSlot + 1) % (count > 0 ? count : 1);
+  for (uint8_t visited = 0; visited < count; visited++) {
+    if (isReady(slot)) {
+      service(slot);
+      spent = micros() - start;
+      if (spent >= _busBudget) {
+        // Out of budget: the next device in line goes first next time
+        nextSlot = (slot + 1) % count;
+        break;
+      }
+    }
+    slot = (slot + 1) % count;
+  }
+  _nextSlot = nextSlot;
+  _lastBusTime = spent;
+  if (ticked) {
+    _ticker.done();
+  }
+  
+  _backlog = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (hasWork(i)) {
+      _backlog++;
+    }
+  }
+  
+  bool ramping = false;
+  for (uint8_t i = 0; i < _motorCount; i++) {
+    if (_motors[i]->getCurrentPower(MOTOR_1) != _motors[i]->getTargetPower(MOTOR_1) ||
+        _motors[i]->getCurrentPower(MOTOR_2) != _motors[i]->getTargetPower(MOTOR_2) ||
+        _motors[i]->isMoving(MOTOR_BOTH)) {
+      ramping = true;
+    }
+  }
+  
+  for (uint8_t i = 0; i < _moveCount; i++) {
+    if (_moves[i]->isMoving()) {
+      ramping = true;
+    }
+  }
+  
+  return ramping || _backlog > 0;
+}
+
+void HiTechnicChain::setTickInterval(uint16_t milliseconds) {
+  _ticker.setPeriod(milliseconds);
+}
+
+// Accept a control rate only if the bus can carry it
+bool HiTechnicChain::setControlRate(uint16_t hz) {
+  if (hz == 0 || hz > 1000) {
+    return false;
+  }
+  
+  uint16_t period = 1000 / hz;
+  uint32_t stepTime = getControlStepTime();
+  if (stepTime * 100 > (uint32_t)period * 1000 * HT_CHAIN_MAX_BUS_LOAD) {
+    return false;
+  }
+  
+  _ticker.setPeriod(period);
+  if (_busBudget < stepTime) {
+    _busBudget = stepTime;
+  }
+  return true;
+}
+
+uint32_t HiTechnicChain::getControlStepTime() {
+  return (uint32_t)_motorCount * HT_CHAIN_SPEED_STEP_BITS * 1000000UL / HT_CHAIN_BUS_CLOCK;
+}
+
+HiTechnicTicker& HiTechnicChain::getTicker() {
+  return _ticker;
+}
+
+void HiTechnicChain::setBusBudget(uint16_t microseconds) {
+  _busBudget = microseconds;
+}
+
+void HiTechnicChain::stopAll() {
+  for (uint8_t i = 0; i < _motorCount; i++) {
+    _motors[i]->stopAll();
+  }
+  flushAll();
+}
+
+void HiTechnicChain::flushAll() {
+  uint8_t count = getDeviceCount();
+  for (uint8_t i = 0; i < count; i++) {
+    service(i);
+  }
+  _backlog = 0;
+}
+
+uint8_t HiTechnicChain::getDeviceCount() {
+  return _motorCount + _servoCount;
+}
+
+unsigned long HiTechnicChain::getLastBusTime() {
+  return _lastBusTime;
+}
+
+uint8_t HiTechnicChain::getBacklog() {
+  return _backlog;
+}
+
+bool HiTechnicChain::hasWork(uint8_t slot) {
+  if (slot < _motorCount) {
+    return _motors[slot]->hasPendingWrites();
+  }
+  return _servos[slot - _motorCount]->hasPendingWrites();
+}
+
+bool HiTechnicChain::isReady(uint8_t slot) {
+  if (slot < _motorCount) {
+    return _motors[slot]->isReady();
+  }
+  return _servos[slot - _motorCount]->isReady();
+}
+
+// Write the device's staged changes; an idle motor controller only reads
+// when its keepalive is due, so idle slots cost next to nothing
+void HiTechnicChain::service(uint8_t slot) {
+  if (slot < _motorCount) {
+    _motors[slot]->flush();
+  } else {
+    _servos[slot - _motorCount]->flush();
+  }
+}
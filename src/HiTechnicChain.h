@@ -0,0 +1,162 @@
+/*
+  HiTechnicChain.h - Single update() for every HiTechnic controller on a
+  daisy chain
+
+  A HiTechnicChain takes over the motor and servo controllers added to it:
+  their setters only stage values (auto flush is turned off) and one
+  update() per loop() steps every ramp on a shared tick and writes the
+  staged changes. Devices are serviced in round-robin slots until the
+  per-update bus budget is spent; whatever is left waits for the next
+  update() and is first in line then. Adding a controller therefore
+  lengthens the time until its writes go out by whole slots instead of
+  stretching the loop.
+
+  Usage:
+    HiTechnicMotor controller1(0x01), controller2(0x02);
+    HiTechnicServo servos(0x03);
+    HiTechnicChain chain;
+
+    chain.addMotor(controller1);
+    chain.addMotor(controller2);
+    chain.addServo(servos);
+    chain.begin();
+
+    loop: controller1.setMotorPowerSmooth(MOTOR_1, 50); ... chain.update();
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicChain_h
+#define HiTechnicChain_h
+
+#include "Arduino.h"
+#include "HiTechnicMotor.h"
+#include "HiTechnicServo.h"
+#include "HiTechnicTicker.h"
+#include "HiTechnicMove.h"
+
+// Controllers one chain can hold (the hardware limit is 4 per chain)
+#ifndef HT_CHAIN_MAX_DEVICES
+#define HT_CHAIN_MAX_DEVICES 8
+#endif
+
+// Coordinated moves one chain can step
+#ifndef HT_CHAIN_MAX_MOVES
+#define HT_CHAIN_MAX_MOVES 4
+#endif
+
+// Default ramp tick (ms), same rate as HiTechnicMotor::update()
+#ifndef HT_CHAIN_TICK_MS
+#define HT_CHAIN_TICK_MS 20
+#endif
+
+// Default bus time one update() may spend (microseconds)
+#ifndef HT_CHAIN_BUS_BUDGET_US
+#define HT_CHAIN_BUS_BUDGET_US 2000
+#endif
+
+// Bus clock the control rate check assumes (Hz)
+#ifndef HT_CHAIN_BUS_CLOCK
+#define HT_CHAIN_BUS_CLOCK 100000UL
+#endif
+
+// Bus bits one speed-controlled motor controller needs per control step:
+// a 20-byte snapshot read with repeated START and a 2-byte power burst,
+// 27 bytes at 9 bits plus START/STOP conditions
+#define HT_CHAIN_SPEED_STEP_BITS 250UL
+
+// Share of each control period the speed loop may occupy the bus (%),
+// leaving room for servo writes and late ticks
+#ifndef HT_CHAIN_MAX_BUS_LOAD
+#define HT_CHAIN_MAX_BUS_LOAD 75
+#endif
+
+class HiTechnicChain {
+  public:
+    HiTechnicChain();
+    
+    // Add a controller; returns false if the chain is full.
+    // Its setters stop writing immediately (auto flush off).
+    bool addMotor(HiTechnicMotor& motor);
+    bool addServo(HiTechnicServo& servo);
+    
+    // Step a coordinated move on the tick (its axes should be motors on
+    // this chain); returns false if the chain has no room for another
+    bool addMove(HiTechnicMove& move);
+    
+    // Initialize every controller added so far
+    void begin();
+    
+    // Step ramps and speed loops and check motion-complete watches when a
+    // tick is due, then write staged changes and
+    // keepalive reads round-robin until the bus budget is spent.
+    // Returns true while any motor is ramping or moving, or any write is
+    // pending.
+    bool update();
+    
+    // Ramp tick in milliseconds (default HT_CHAIN_TICK_MS). Ticks run on
+    // a fixed schedule; missed ones are caught up on the next update().
+    // 0 is treated as 1 ms.
+    void setTickInterval(uint16_t milliseconds);
+    
+    // Run the tick, and with it every motor's speed PID
+    // (HiTechnicMotor::setTargetVelocity), at hz (rounded to a whole
+    // millisecond period). Returns false and keeps the current rate if the
+    // controllers added so far would need more than HT_CHAIN_MAX_BUS_LOAD
+    // percent of the bus at that rate; on success the bus budget is raised
+    // to cover one step if needed.
+    bool setControlRate(uint16_t hz);
+    
+    // Bus time one control step of every motor controller takes
+    // (microseconds, estimated at HT_CHAIN_BUS_CLOCK)
+    uint32_t getControlStepTime();
+    
+    // Tick timing statistics; a tick's work time covers the ramp step and
+    // the bus slots of the update() that ran it
+    HiTechnicTicker& getTicker();
+    
+    // Bus time one update() may spend in microseconds (default
+    // HT_CHAIN_BUS_BUDGET_US), including the tick's snapshot reads for
+    // speed loops and motion watches. At least one device is serviced
+    // per update() regardless, so a small budget cannot stall the chain.
+    void setBusBudget(uint16_t microseconds);
+    
+    // Stop every motor and write all pending changes now, ignoring the
+    // budget
+    void stopAll();
+    
+    // Write all pending changes now, ignoring the budget
+    void flushAll();
+    
+    // Number of controllers on the chain
+    uint8_t getDeviceCount();
+    
+    // Bus time spent by the last update(), tick reads included
+    // (microseconds)
+    unsigned long getLastBusTime();
+    
+    // Devices that still had writes pending after the last update()
+    uint8_t getBacklog();
+    
+  private:
+    HiTechnicMotor* _motors[HT_CHAIN_MAX_DEVICES];
+    HiTechnicServo* _servos[HT_CHAIN_MAX_DEVICES];
+    uint8_t _motorCount;
+    uint8_t _servoCount;
+    HiTechnicMove* _moves[HT_CHAIN_MAX_MOVES];
+    uint8_t _moveCount;
+    
+    uint8_t _nextSlot;              // Device serviced first in the next update()
+    HiTechnicTicker _ticker;
+    uint16_t _busBudget;
+    
+    unsigned long _lastBusTime;
+    uint8_t _backlog;
+    
+    // Slots number motors first, then servos
+    bool hasWork(uint8_t slot);
+    bool isReady(uint8_t slot);
+    void service(uint8_t slot);
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+  HiTechnicMailbox.cpp - Lock-free command mailbox between an interrupt
+  and the control loop
+*/
+
+#include "HiTechnicMailbox.h"
+
+// Constructor
+HiTechnicMailbox::HiTechnicMailbox() {
+  for (uint8_t i = 0; i < HT_MAILBOX_CHANNELS; i++) {
+    _values[i] = 0;
+    _versions[i] = 0;
+    _taken[i] = 0;
+  }
+  for (uint8_t i = 0; i < HT_MAILBOX_EVENTS; i++) {
+    _events[i] = 0;
+    _eventsTaken[i] = 0;
+  }
+  _overwrites = 0;
+}
+
+// Value first, then the version the consumer checks
+void HiTechnicMailbox::post(uint8_t channel, int32_t value) {
+  if (channel >= HT_MAILBOX_CHANNELS) {
+    return;
+  }
+  uint8_t version = _versions[channel];
+  if (version != _taken[channel]) {
+    _overwrites++;
+  }
+  _values[channel] = value;
+  _versions[channel] = version + 1;
+}
+
+void HiTechnicMailbox::postEvent(uint8_t event) {
+  if (event < HT_MAILBOX_EVENTS) {
+    _events[event] = _events[event] + 1;
+  }
+}
+
+bool HiTechnicMailbox::take(uint8_t channel, int32_t& value) {
+  if (channel >= HT_MAILBOX_CHANNELS) {
+    return false;
+  }
+  uint8_t version = _versions[channel];
+  if (version == _taken[channel]) {
+    return false;
+  }
+
+  // Retry if a post landed while the value was being read
+  int32_t latest;
+  do {
+    version = _versions[channel];
+    latest = _values[channel];
+  } while (version != _versions[channel]);
+
+  _taken[channel] = version;
+  value = latest;
+  return true;
+}
+
+bool HiTechnicMailbox::takeEvent(uint8_t event) {
+  if (event >= HT_MAILBOX_EVENTS) {
+    return false;
+  }
+  uint8_t count = _events[event];
+  if (count == _eventsTaken[event]) {
+    return false;
+  }
+  _eventsTaken[event] = count;
+  return true;
+}
+
+int32_t HiTechnicMailbox::peek(uint8_t channel) {
+  if (channel >= HT_MAILBOX_CHANNELS) {
+    return 0;
+  }
+  int32_t latest;
+  uint8_t version;
+  do {
+    version = _versions[channel];
+    latest = _values[channel];
+  } while (version != _versions[channel]);
+  return latest;
+}
+
+// 32-bit read while the producer may update it: read until stable
+uint32_t HiTechnicMailbox::getOverwriteCount() {
+  uint32_t count;
+  do {
+    count = _overwrites;
+  } while (count != _overwrites);
+  return count;
+}
@@ -0,0 +1,83 @@
+/*
+  HiTechnicMailbox.h - Lock-free command mailbox between an interrupt
+  and the control loop
+
+  One producer (an interrupt handler that parses incoming frames) posts
+  setpoints, one consumer (the control tick in loop()) takes them. Each
+  channel holds only its latest value: a setpoint posted before the last
+  one was taken replaces it, so a backlog is never replayed as a string
+  of stale commands. Events (stop, reset, ...) are counted instead, and
+  takeEvent() reports each once however often it was posted meanwhile.
+
+  Neither side disables interrupts or waits. The producer writes a
+  channel's value and then bumps its version byte; since the producer
+  runs as an interrupt it can never be interrupted by the consumer. The
+  consumer reads version, value, version and retries if the two versions
+  differ, i.e. if the interrupt posted while it was reading. Every
+  variable has a single writer and multi-byte values are only read under
+  that check, so this holds on 8-bit AVR, where a 32-bit read can be
+  torn, as well as on single-core ARM boards.
+
+  Versions are single bytes: the consumer has to take a channel at least
+  once per 255 posts to it (at 57600 baud, about half a second of
+  back-to-back commands).
+
+  Usage:
+    HiTechnicMailbox mailbox;
+
+    ISR:  mailbox.post(channel, value); mailbox.postEvent(event);
+    loop: int32_t value;
+          if (mailbox.take(channel, value)) { ... }
+          if (mailbox.takeEvent(event)) { ... }
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicMailbox_h
+#define HiTechnicMailbox_h
+
+#include "Arduino.h"
+
+// Setpoint channels
+#ifndef HT_MAILBOX_CHANNELS
+#define HT_MAILBOX_CHANNELS 8
+#endif
+
+// Event kinds
+#ifndef HT_MAILBOX_EVENTS
+#define HT_MAILBOX_EVENTS 4
+#endif
+
+class HiTechnicMailbox {
+  public:
+    HiTechnicMailbox();
+
+    // Producer side (interrupt context)
+    void post(uint8_t channel, int32_t value);
+    void postEvent(uint8_t event);
+
+    // Consumer side. take() returns true and the latest value if the
+    // channel was posted since the last take(); takeEvent() returns true
+    // if the event was posted since the last takeEvent().
+    bool take(uint8_t channel, int32_t& value);
+    bool takeEvent(uint8_t event);
+
+    // Latest value of a channel whether taken or not (consumer side)
+    int32_t peek(uint8_t channel);
+
+    // Setpoints replaced before the consumer took them (producer count)
+    uint32_t getOverwriteCount();
+
+  private:
+    // Written by the producer only
+    volatile int32_t _values[HT_MAILBOX_CHANNELS];
+    volatile uint8_t _versions[HT_MAILBOX_CHANNELS];
+    volatile uint8_t _events[HT_MAILBOX_EVENTS];
+    volatile uint32_t _overwrites;
+
+    // Written by the consumer only
+    volatile uint8_t _taken[HT_MAILBOX_CHANNELS];
+    uint8_t _eventsTaken[HT_MAILBOX_EVENTS];
+};
+
+#endif
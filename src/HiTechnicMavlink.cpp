@@ -0,0 +1,413 @@
+/*
+  HiTechnicMavlink.cpp - Minimal MAVLink v2 endpoint for HiTechnic
+  motors and servos
+*/
+
+#include "HiTechnicMavlink.h"
+#include "HiTechnicProtocol.h"
+
+// Receive states
+#define HT_MAV_RX_STX        0
+#define HT_MAV_RX_LENGTH     1
+#define HT_MAV_RX_INCOMPAT   2
+#define HT_MAV_RX_COMPAT     3
+#define HT_MAV_RX_SEQUENCE   4
+#define HT_MAV_RX_SYSTEM     5
+#define HT_MAV_RX_COMPONENT  6
+#define HT_MAV_RX_ID0        7
+#define HT_MAV_RX_ID1        8
+#define HT_MAV_RX_ID2        9
+#define HT_MAV_RX_PAYLOAD    10
+#define HT_MAV_RX_CRC_LOW    11
+#define HT_MAV_RX_CRC_HIGH   12
+#define HT_MAV_RX_SIGNATURE  13
+
+#define HT_MAV_HEADER_LENGTH    10  // STX through message ID
+#define HT_MAV_SIGNATURE_LENGTH 13
+#define HT_MAV_IFLAG_SIGNED     0x01
+
+// Payload lengths of the subset
+#define HT_MAV_HEARTBEAT_LENGTH       9
+#define HT_MAV_SET_ACTUATOR_LENGTH    43
+#define HT_MAV_ACTUATOR_LENGTH        41
+#define HT_MAV_DEBUG_VECT_LENGTH      30
+#define HT_MAV_NAMED_VALUE_INT_LENGTH 18
+
+// Constructor
+HiTechnicMavlink::HiTechnicMavlink(Print& out, uint8_t systemId, uint8_t componentId) {
+  _out = &out;
+  _systemId = systemId;
+  _componentId = componentId;
+  _group = 0;
+  _channelCount = 0;
+  _txSequence = 0;
+  _frames = 0;
+  _crcErrors = 0;
+  _skipped = 0;
+  reset();
+}
+
+bool HiTechnicMavlink::addMotor(HiTechnicMotor& controller, uint8_t motor) {
+  if (_channelCount >= HT_MAVLINK_CHANNELS || (motor != MOTOR_1 && motor != MOTOR_2)) {
+    return false;
+  }
+  _motors[_channelCount] = &controller;
+  _servos[_channelCount] = NULL;
+  _outputs[_channelCount] = motor;
+  _channelCount++;
+  return true;
+}
+
+bool HiTechnicMavlink::addServo(HiTechnicServo& controller, uint8_t servo) {
+  if (_channelCount >= HT_MAVLINK_CHANNELS || servo < 1 || servo > 6) {
+    return false;
+  }
+  _motors[_channelCount] = NULL;
+  _servos[_channelCount] = &controller;
+  _outputs[_channelCount] = servo;
+  _channelCount++;
+  return true;
+}
+
+void HiTechnicMavlink::setGroup(uint8_t group) {
+  _group = group;
+}
+
+void HiTechnicMavlink::reset() {
+  _state = HT_MAV_RX_STX;
+  _valid = false;
+}
+
+// Payload length of a message in the subset, 0 for any other ID
+static uint8_t messageLength(uint32_t id) {
+  switch (id) {
+    case HT_MAVLINK_MSG_HEARTBEAT:                   return HT_MAV_HEARTBEAT_LENGTH;
+    case HT_MAVLINK_MSG_SET_ACTUATOR_CONTROL_TARGET: return HT_MAV_SET_ACTUATOR_LENGTH;
+    case HT_MAVLINK_MSG_ACTUATOR_CONTROL_TARGET:     return HT_MAV_ACTUATOR_LENGTH;
+    case HT_MAVLINK_MSG_DEBUG_VECT:                  return HT_MAV_DEBUG_VECT_LENGTH;
+    case HT_MAVLINK_MSG_NAMED_VALUE_INT:             return HT_MAV_NAMED_VALUE_INT_LENGTH;
+  }
+  return 0;
+}
+
+int16_t HiTechnicMavlink::crcExtra(uint32_t id) {
+  switch (id) {
+    case HT_MAVLINK_MSG_HEARTBEAT:                   return 50;
+    case HT_MAVLINK_MSG_SET_ACTUATOR_CONTROL_TARGET: return 168;
+    case HT_MAVLINK_MSG_ACTUATOR_CONTROL_TARGET:     return 181;
+    case HT_MAVLINK_MSG_DEBUG_VECT:                  return 49;
+    case HT_MAVLINK_MSG_NAMED_VALUE_INT:             return 44;
+  }
+  return -1;
+}
+
+// Advance the receive state machine by one byte. Frames outside the
+// subset are followed by length so the parser stays in step, but their
+// payload is not stored.
+bool HiTechnicMavlink::parse(uint8_t data) {
+  _valid = false;
+
+  switch (_state) {
+    case HT_MAV_RX_STX:
+      if (data == HT_MAVLINK_STX) {
+        _crc = 0xFFFF;
+        _state = HT_MAV_RX_LENGTH;
+      }
+      return false;
+
+    case HT_MAV_RX_LENGTH:
+      _length = data;
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _state = HT_MAV_RX_INCOMPAT;
+      return false;
+
+    case HT_MAV_RX_INCOMPAT:
+      _incompat = data;
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _state = HT_MAV_RX_COMPAT;
+      return false;
+
+    case HT_MAV_RX_COMPAT:
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _state = HT_MAV_RX_SEQUENCE;
+      return false;
+
+    case HT_MAV_RX_SEQUENCE:
+      _sequence = data;
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _state = HT_MAV_RX_SYSTEM;
+      return false;
+
+    case HT_MAV_RX_SYSTEM:
+      _sourceSystem = data;
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _state = HT_MAV_RX_COMPONENT;
+      return false;
+
+    case HT_MAV_RX_COMPONENT:
+      _sourceComponent = data;
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _state = HT_MAV_RX_ID0;
+      return false;
+
+    case HT_MAV_RX_ID0:
+      _id = data;
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _state = HT_MAV_RX_ID1;
+      return false;
+
+    case HT_MAV_RX_ID1:
+      _id |= (uint32_t)data << 8;
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _state = HT_MAV_RX_ID2;
+      return false;
+
+    case HT_MAV_RX_ID2:
+      _id |= (uint32_t)data << 16;
+      _crc = HiTechnicProtocol::crc16(_crc, data);
+      _index = 0;
+      // Unknown messages, oversized payloads and incompatibility flags
+      // other than signing cannot be checked or decoded
+      _skip = (crcExtra(_id) < 0 ||
+               _length > messageLength(_id) ||
+               (_incompat & ~HT_MAV_IFLAG_SIGNED) != 0);
+      _state = (_length > 0) ? HT_MAV_RX_PAYLOAD : HT_MAV_RX_CRC_LOW;
+      return false;
+
+    case HT_MAV_RX_PAYLOAD:
+      if (!_skip) {
+        _buffer[_index] = data;
+        _crc = HiTechnicProtocol::crc16(_crc, data);
+      }
+      _index++;
+      if (_index >= _length) {
+        _state = HT_MAV_RX_CRC_LOW;
+      }
+      return false;
+
+    case HT_MAV_RX_CRC_LOW:
+      _crcLow = data;
+      _state = HT_MAV_RX_CRC_HIGH;
+      return false;
+
+    case HT_MAV_RX_CRC_HIGH: {
+      _index = 0;
+      _state = (_incompat & HT_MAV_IFLAG_SIGNED) ? HT_MAV_RX_SIGNATURE : HT_MAV_RX_STX;
+      if (_skip) {
+        _skipped++;
+        return false;
+      }
+      uint16_t crc = HiTechnicProtocol::crc16(_crc, (uint8_t)crcExtra(_id));
+      if ((((uint16_t)data << 8) | _crcLow) != crc) {
+        _crcErrors++;
+        return false;
+      }
+
+      // Restore the trailing zeros the sender truncated
+      uint8_t full = messageLength(_id);
+      for (uint8_t i = _length; i < full; i++) {
+        _buffer[i] = 0;
+      }
+      _length = full;
+      _frames++;
+      _valid = true;
+      return true;
+    }
+
+    case HT_MAV_RX_SIGNATURE:
+      // Link ID, timestamp and signature, not verified
+      if (++_index >= HT_MAV_SIGNATURE_LENGTH) {
+        _state = HT_MAV_RX_STX;
+      }
+      return false;
+  }
+
+  _state = HT_MAV_RX_STX;
+  return false;
+}
+
+uint32_t HiTechnicMavlink::getMessageId() {
+  return _id;
+}
+
+uint8_t HiTechnicMavlink::getSystemId() {
+  return _sourceSystem;
+}
+
+uint8_t HiTechnicMavlink::getComponentId() {
+  return _sourceComponent;
+}
+
+uint8_t HiTechnicMavlink::getSequence() {
+  return _sequence;
+}
+
+// Wire order of both messages: time_usec, controls[8], group_mlx, then
+// (SET_ only) target_system, target_component
+bool HiTechnicMavlink::readControls(float controls[HT_MAVLINK_CHANNELS], uint8_t& group) {
+  if (!_valid || (_id != HT_MAVLINK_MSG_SET_ACTUATOR_CONTROL_TARGET &&
+                  _id != HT_MAVLINK_MSG_ACTUATOR_CONTROL_TARGET)) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < HT_MAVLINK_CHANNELS; i++) {
+    controls[i] = readFloat(_buffer + 8 + i * 4);
+  }
+  group = _buffer[40];
+  return true;
+}
+
+bool HiTechnicMavlink::apply() {
+  float controls[HT_MAVLINK_CHANNELS];
+  uint8_t group;
+  if (!readControls(controls, group) || group != _group) {
+    return false;
+  }
+  if (_id == HT_MAVLINK_MSG_SET_ACTUATOR_CONTROL_TARGET) {
+    uint8_t targetSystem = _buffer[41];
+    uint8_t targetComponent = _buffer[42];
+    if ((targetSystem != 0 && targetSystem != _systemId) ||
+        (targetComponent != 0 && targetComponent != _componentId)) {
+      return false;
+    }
+  }
+
+  for (uint8_t i = 0; i < _channelCount; i++) {
+    float control = controls[i];
+    if (control != control) {
+      continue;  // NaN: leave the channel alone
+    }
+    if (control > 1.0f) control = 1.0f;
+    if (control < -1.0f) control = -1.0f;
+
+    if (_motors[i] != NULL) {
+      float power = control * 100.0f;
+      _motors[i]->setMotorPower(_outputs[i], (int8_t)(power < 0 ? power - 0.5f : power + 0.5f));
+    } else {
+      _servos[i]->setServoPosition(_outputs[i], (uint8_t)((control + 1.0f) * 127.5f + 0.5f));
+    }
+  }
+  return true;
+}
+
+// MAV_TYPE_ONBOARD_CONTROLLER, MAV_AUTOPILOT_INVALID, MAV_STATE_ACTIVE
+size_t HiTechnicMavlink::sendHeartbeat() {
+  uint8_t payload[HT_MAV_HEARTBEAT_LENGTH] = {0, 0, 0, 0, 18, 8, 0, 4, 3};
+  return sendMessage(HT_MAVLINK_MSG_HEARTBEAT, payload, HT_MAV_HEARTBEAT_LENGTH);
+}
+
+// Wire order: time_boot_ms, value, name[10]
+size_t HiTechnicMavlink::sendNamedInt(const char* name, int32_t value) {
+  uint8_t payload[HT_MAV_NAMED_VALUE_INT_LENGTH];
+  HiTechnicProtocol::writeInt32(payload, (int32_t)millis());
+  HiTechnicProtocol::writeInt32(payload + 4, value);
+  writeName(payload + 8, name);
+  return sendMessage(HT_MAVLINK_MSG_NAMED_VALUE_INT, payload, HT_MAV_NAMED_VALUE_INT_LENGTH);
+}
+
+// Wire order: time_usec (uint64), x, y, z, name[10]
+size_t HiTechnicMavlink::sendDebugVect(const char* name, float x, float y, float z) {
+  uint8_t payload[HT_MAV_DEBUG_VECT_LENGTH];
+  HiTechnicProtocol::writeInt32(payload, (int32_t)micros());
+  HiTechnicProtocol::writeInt32(payload + 4, 0);
+  writeFloat(payload + 8, x);
+  writeFloat(payload + 12, y);
+  writeFloat(payload + 16, z);
+  writeName(payload + 20, name);
+  return sendMessage(HT_MAVLINK_MSG_DEBUG_VECT, payload, HT_MAV_DEBUG_VECT_LENGTH);
+}
+
+size_t HiTechnicMavlink::sendEncoders() {
+  size_t written = 0;
+  char name[] = "ENC1";
+  for (uint8_t i = 0; i < _channelCount; i++) {
+    if (_motors[i] != NULL) {
+      name[3] = '1' + i;
+      written += sendNamedInt(name, _motors[i]->getEncoder(_outputs[i]));
+    }
+  }
+  return written;
+}
+
+// Servo channels in a group of three send 0
+size_t HiTechnicMavlink::sendVelocities() {
+  size_t written = 0;
+  char name[] = "VEL1";
+  for (uint8_t i = 0; i < _channelCount; i += 3) {
+    float v[3] = {0, 0, 0};
+    bool any = false;
+    for (uint8_t j = 0; j < 3 && i + j < _channelCount; j++) {
+      if (_motors[i + j] != NULL) {
+        v[j] = (float)_motors[i + j]->getVelocity(_outputs[i + j]);
+        any = true;
+      }
+    }
+    if (any) {
+      name[3] = '1' + i;
+      written += sendDebugVect(name, v[0], v[1], v[2]);
+    }
+  }
+  return written;
+}
+
+uint32_t HiTechnicMavlink::getFrameCount() {
+  return _frames;
+}
+
+uint32_t HiTechnicMavlink::getCrcErrors() {
+  return _crcErrors;
+}
+
+uint32_t HiTechnicMavlink::getSkipCount() {
+  return _skipped;
+}
+
+// Header, payload and CRC go out as they are produced. Trailing zero
+// bytes of the payload are truncated as MAVLink v2 requires (at least
+// one byte stays).
+size_t HiTechnicMavlink::sendMessage(uint32_t id, const uint8_t* payload, uint8_t length) {
+  while (length > 1 && payload[length - 1] == 0) {
+    length--;
+  }
+
+  uint8_t header[HT_MAV_HEADER_LENGTH] = {
+    HT_MAVLINK_STX, length, 0, 0, _txSequence++, _systemId, _componentId,
+    (uint8_t)(id & 0xFF), (uint8_t)((id >> 8) & 0xFF), (uint8_t)((id >> 16) & 0xFF)
+  };
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 1; i < HT_MAV_HEADER_LENGTH; i++) {
+    crc = HiTechnicProtocol::crc16(crc, header[i]);
+  }
+  for (uint8_t i = 0; i < length; i++) {
+    crc = HiTechnicProtocol::crc16(crc, payload[i]);
+  }
+  crc = HiTechnicProtocol::crc16(crc, (uint8_t)crcExtra(id));
+
+  size_t written = _out->write(header, HT_MAV_HEADER_LENGTH);
+  written += _out->write(payload, length);
+  written += _out->write((uint8_t)(crc & 0xFF));
+  written += _out->write((uint8_t)(crc >> 8));
+  return written;
+}
+
+// char[10], zero padded, no terminator when the name fills it
+void HiTechnicMavlink::writeName(uint8_t* data, const char* name) {
+  uint8_t i = 0;
+  for (; i < HT_MAVLINK_NAME_LENGTH && name[i] != '\0'; i++) {
+    data[i] = name[i];
+  }
+  for (; i < HT_MAVLINK_NAME_LENGTH; i++) {
+    data[i] = 0;
+  }
+}
+
+// IEEE 754 single, little-endian on the wire and on AVR/ARM
+float HiTechnicMavlink::readFloat(const uint8_t* data) {
+  float value;
+  memcpy(&value, data, 4);
+  return value;
+}
+
+void HiTechnicMavlink::writeFloat(uint8_t* data, float value) {
+  memcpy(data, &value, 4);
+}
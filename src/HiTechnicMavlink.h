@@ -0,0 +1,162 @@
+/*
+  HiTechnicMavlink.h - Minimal MAVLink v2 endpoint that maps actuator
+  controls onto HiTechnic motors and servos
+
+  Implements just enough of MAVLink v2 for a flight controller to drive
+  the controllers directly, without a text bridge or the generated
+  MAVLink headers:
+
+    In:  SET_ACTUATOR_CONTROL_TARGET (139), ACTUATOR_CONTROL_TARGET (140)
+    Out: HEARTBEAT (0), NAMED_VALUE_INT (252), DEBUG_VECT (250)
+
+  Each motor or servo added is one actuator channel, in the order added;
+  channel n follows controls[n] of the selected control group (-1..1).
+  Motors get controls * 100 as power, servos map -1..1 onto 0..255. A NaN
+  control leaves its channel unchanged.
+
+  The parser takes one byte at a time and checks the CRC including each
+  message's CRC_EXTRA. Messages outside the subset are skipped by length
+  without being buffered; only the largest supported payload (43 bytes)
+  is held in RAM. Truncated payloads (trailing zeros dropped, as MAVLink
+  v2 senders do) are zero-extended. Signed frames are accepted but the
+  signature is not checked.
+
+  Usage:
+    HiTechnicMavlink mavlink(Serial1);
+
+    setup: mavlink.addMotor(controller1, MOTOR_1); ...
+           mavlink.addServo(servos, 1); ...
+    loop:  while (Serial1.available()) {
+             if (mavlink.parse(Serial1.read())) {
+               mavlink.apply();
+             }
+           }
+           mavlink.sendEncoders();
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicMavlink_h
+#define HiTechnicMavlink_h
+
+#include "Arduino.h"
+#include "HiTechnicMotor.h"
+#include "HiTechnicServo.h"
+
+#define HT_MAVLINK_STX 0xFD
+
+// Actuator channels (size of the controls array in one control group)
+#define HT_MAVLINK_CHANNELS 8
+
+// Default component ID (MAV_COMP_ID_USER1)
+#define HT_MAVLINK_COMPONENT 25
+
+// Message IDs in the subset
+#define HT_MAVLINK_MSG_HEARTBEAT                    0
+#define HT_MAVLINK_MSG_SET_ACTUATOR_CONTROL_TARGET  139
+#define HT_MAVLINK_MSG_ACTUATOR_CONTROL_TARGET      140
+#define HT_MAVLINK_MSG_DEBUG_VECT                   250
+#define HT_MAVLINK_MSG_NAMED_VALUE_INT              252
+
+// Largest payload kept by the parser (SET_ACTUATOR_CONTROL_TARGET)
+#define HT_MAVLINK_MAX_PAYLOAD 43
+
+// Length of the name field in NAMED_VALUE_INT and DEBUG_VECT
+#define HT_MAVLINK_NAME_LENGTH 10
+
+class HiTechnicMavlink {
+  public:
+    // Frames are sent to out with the given system and component IDs
+    HiTechnicMavlink(Print& out, uint8_t systemId = 1, uint8_t componentId = HT_MAVLINK_COMPONENT);
+
+    // Add the next actuator channel; false once all channels are used
+    bool addMotor(HiTechnicMotor& controller, uint8_t motor);
+    bool addServo(HiTechnicServo& controller, uint8_t servo);
+
+    // Control group the channels follow (group_mlx, default 0)
+    void setGroup(uint8_t group);
+
+    // Feed one received byte. Returns true when it completed a valid
+    // frame of the subset; the frame can be read until the next call.
+    bool parse(uint8_t data);
+
+    // Drop any partly received frame
+    void reset();
+
+    // Header of the last completed frame
+    uint32_t getMessageId();
+    uint8_t getSystemId();
+    uint8_t getComponentId();
+    uint8_t getSequence();
+
+    // Controls of the last frame if it is an (SET_)ACTUATOR_CONTROL_TARGET;
+    // group receives its group_mlx
+    bool readControls(float controls[HT_MAVLINK_CHANNELS], uint8_t& group);
+
+    // Write the last frame's controls to the channels if it carries the
+    // selected group and (for SET_) is addressed to this system and
+    // component or broadcast. Returns true if the channels were updated.
+    bool apply();
+
+    // Telemetry; time fields are filled from millis()/micros(). Names
+    // longer than 10 characters are cut.
+    size_t sendHeartbeat();
+    size_t sendNamedInt(const char* name, int32_t value);
+    size_t sendDebugVect(const char* name, float x, float y, float z);
+
+    // NAMED_VALUE_INT "ENC<n>" for every motor channel n (1-based) from
+    // getEncoder(); refresh the encoders first (readState() or a chain)
+    size_t sendEncoders();
+
+    // DEBUG_VECT "VEL<n>" with getVelocity() of motor channels n..n+2 in
+    // counts per second
+    size_t sendVelocities();
+
+    // Receive statistics
+    uint32_t getFrameCount();    // Valid frames in the subset
+    uint32_t getCrcErrors();     // Frames in the subset with a bad CRC
+    uint32_t getSkipCount();     // Frames outside the subset or oversized
+
+    // CRC_EXTRA of a message in the subset, -1 for any other ID
+    static int16_t crcExtra(uint32_t id);
+
+  private:
+    Print* _out;
+    uint8_t _systemId;
+    uint8_t _componentId;
+    uint8_t _group;
+
+    // Actuator channels: exactly one of motor and servo is set
+    HiTechnicMotor* _motors[HT_MAVLINK_CHANNELS];
+    HiTechnicServo* _servos[HT_MAVLINK_CHANNELS];
+    uint8_t _outputs[HT_MAVLINK_CHANNELS];  // MOTOR_1/MOTOR_2 or servo 1-6
+    uint8_t _channelCount;
+
+    // Receive state
+    uint8_t _state;
+    uint8_t _buffer[HT_MAVLINK_MAX_PAYLOAD];
+    uint8_t _length;
+    uint8_t _incompat;
+    uint8_t _sequence;
+    uint8_t _sourceSystem;
+    uint8_t _sourceComponent;
+    uint32_t _id;
+    uint8_t _index;
+    uint16_t _crc;
+    uint8_t _crcLow;
+    bool _skip;                  // Frame is counted and discarded
+    bool _valid;                 // Fields above hold a completed frame
+
+    uint8_t _txSequence;
+
+    uint32_t _frames;
+    uint32_t _crcErrors;
+    uint32_t _skipped;
+
+    size_t sendMessage(uint32_t id, const uint8_t* payload, uint8_t length);
+    static void writeName(uint8_t* data, const char* name);
+    static float readFloat(const uint8_t* data);
+    static void writeFloat(uint8_t* data, float value);
+};
+
+#endif
@@ -0,0 +1,144 @@
+/*
+  HiTechnicMockBus.cpp - In-memory HiTechnicBus for host-side testing and
+  benchmarking
+*/
+
+#include "HiTechnicMockBus.h"
+
+// Constructor
+HiTechnicMockBus::HiTechnicMockBus() {
+  _deviceCount = 0;
+  _txAddress = 0;
+  _txLength = 0;
+  _rxLength = 0;
+  _rxIndex = 0;
+  resetCounters();
+}
+
+// Attach a device with a zeroed register file
+bool HiTechnicMockBus::addDevice(uint8_t address) {
+  if (findDevice(address) >= 0) {
+    return true;
+  }
+  if (_deviceCount >= HT_MOCK_MAX_DEVICES) {
+    return false;
+  }
+
+  _addresses[_deviceCount] = address;
+  memset(_registers[_deviceCount], 0, sizeof(_registers[_deviceCount]));
+  _pointers[_deviceCount] = 0;
+  _deviceCount++;
+  return true;
+}
+
+// Register file of an attached device
+uint8_t* HiTechnicMockBus::registers(uint8_t address) {
+  int8_t device = findDevice(address);
+  if (device < 0) {
+    return NULL;
+  }
+  return _registers[device];
+}
+
+uint32_t HiTechnicMockBus::transactions() {
+  return _transactions;
+}
+
+uint32_t HiTechnicMockBus::bytesWritten() {
+  return _bytesWritten;
+}
+
+uint32_t HiTechnicMockBus::bytesRead() {
+  return _bytesRead;
+}
+
+uint32_t HiTechnicMockBus::repeatedStarts() {
+  return _repeatedStarts;
+}
+
+void HiTechnicMockBus::resetCounters() {
+  _transactions = 0;
+  _bytesWritten = 0;
+  _bytesRead = 0;
+  _repeatedStarts = 0;
+}
+
+void HiTechnicMockBus::begin() {
+}
+
+void HiTechnicMockBus::beginTransmission(uint8_t address) {
+  _txAddress = address;
+  _txLength = 0;
+}
+
+size_t HiTechnicMockBus::write(uint8_t data) {
+  if (_txLength >= HT_MOCK_BUFFER_SIZE) {
+    return 0;
+  }
+  _txBuffer[_txLength++] = data;
+  return 1;
+}
+
+// Apply the buffered write: first byte is the register pointer
+uint8_t HiTechnicMockBus::endTransmission(bool sendStop) {
+  _transactions++;
+  _bytesWritten += _txLength;
+  if (!sendStop) {
+    _repeatedStarts++;
+  }
+
+  int8_t device = findDevice(_txAddress);
+  if (device < 0) {
+    return 2;  // NACK on address
+  }
+
+  if (_txLength > 0) {
+    _pointers[device] = _txBuffer[0];
+    for (uint8_t i = 1; i < _txLength; i++) {
+      _registers[device][_pointers[device]++] = _txBuffer[i];
+    }
+  }
+  return 0;
+}
+
+// Read from the device's register pointer, auto-incrementing
+uint8_t HiTechnicMockBus::requestFrom(uint8_t address, uint8_t quantity) {
+  _transactions++;
+  _rxLength = 0;
+  _rxIndex = 0;
+
+  int8_t device = findDevice(address);
+  if (device < 0) {
+    return 0;
+  }
+
+  if (quantity > HT_MOCK_BUFFER_SIZE) {
+    quantity = HT_MOCK_BUFFER_SIZE;
+  }
+  for (uint8_t i = 0; i < quantity; i++) {
+    _rxBuffer[_rxLength++] = _registers[device][_pointers[device]++];
+  }
+  _bytesRead += _rxLength;
+  return _rxLength;
+}
+
+int HiTechnicMockBus::available() {
+  return _rxLength - _rxIndex;
+}
+
+int HiTechnicMockBus::read() {
+  if (_rxIndex < _rxLength) {
+    return _rxBuffer[_rxIndex++];
+  }
+  return -1;
+}
+
+// Index of the device at address, -1 if not attached
+int8_t HiTechnicMockBus::findDevice(uint8_t address) {
+  for (uint8_t i = 0; i < _deviceCount; i++) {
+    if (_addresses[i] == address) {
+      return i;
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,73 @@
+/*
+  HiTechnicMockBus.h - In-memory HiTechnicBus for host-side testing and
+  benchmarking
+
+  Each attached device is a 256-byte register file with the same
+  auto-incrementing register pointer the HiTechnic controllers use: the
+  first byte of a write sets the pointer, following bytes are stored at
+  it, and reads continue from it. Transaction and byte counters make it
+  possible to measure how much bus traffic a sketch generates without
+  hardware.
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicMockBus_h
+#define HiTechnicMockBus_h
+
+#include "HiTechnicBus.h"
+
+// Number of devices one mock bus can hold
+#ifndef HT_MOCK_MAX_DEVICES
+#define HT_MOCK_MAX_DEVICES 4
+#endif
+
+#define HT_MOCK_BUFFER_SIZE 32
+
+class HiTechnicMockBus : public HiTechnicBus {
+  public:
+    HiTechnicMockBus();
+
+    // Attach a device at address, returns false if the bus is full
+    bool addDevice(uint8_t address);
+
+    // Register file of the device at address (NULL if not attached)
+    uint8_t* registers(uint8_t address);
+
+    // Traffic counters since the last resetCounters()
+    uint32_t transactions();
+    uint32_t bytesWritten();
+    uint32_t bytesRead();
+    uint32_t repeatedStarts();  // Writes ended without STOP
+    void resetCounters();
+
+    void begin();
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    int available();
+    int read();
+
+  private:
+    uint8_t _addresses[HT_MOCK_MAX_DEVICES];
+    uint8_t _registers[HT_MOCK_MAX_DEVICES][256];
+    uint8_t _pointers[HT_MOCK_MAX_DEVICES];
+    uint8_t _deviceCount;
+
+    uint8_t _txAddress;
+    uint8_t _txBuffer[HT_MOCK_BUFFER_SIZE];
+    uint8_t _txLength;
+    uint8_t _rxBuffer[HT_MOCK_BUFFER_SIZE];
+    uint8_t _rxLength;
+    uint8_t _rxIndex;
+
+    uint32_t _transactions;
+    uint32_t _bytesWritten;
+    uint32_t _bytesRead;
+    uint32_t _repeatedStarts;
+
+    int8_t findDevice(uint8_t address);
+};
+
+#endif
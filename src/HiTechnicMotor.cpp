@@ -5,22 +5,59 @@
 
 #include "HiTechnicMotor.h"
 
+// Normalized profile shapes: fraction of the power change (0-255) reached
+// at each of the HT_PROFILE_STEPS + 1 evenly spaced times
+static const uint8_t HT_SHAPE_EXPONENTIAL[HT_PROFILE_STEPS + 1] = {
+  0, 57, 102, 137, 164, 185, 202, 215, 225, 232, 238, 243, 247, 250, 252, 254, 255
+};  // (1 - e^-4x) / (1 - e^-4)
+static const uint8_t HT_SHAPE_SCURVE[HT_PROFILE_STEPS + 1] = {
+  0, 3, 11, 24, 40, 59, 81, 104, 128, 151, 174, 196, 215, 231, 244, 252, 255
+};  // 3x^2 - 2x^3
+
 // Constructor
-HiTechnicMotor::HiTechnicMotor(uint8_t address) {
+HiTechnicMotor::HiTechnicMotor(uint8_t address, HiTechnicBus& bus) {
   _address = address;
+  _bus = &bus;
+  _lastWriteTime = 0;
+  _lastAccessTime = 0;
   _motor1TargetPower = 0;
   _motor2TargetPower = 0;
   _motor1CurrentPower = 0;
   _motor2CurrentPower = 0;
-  _acceleration = 10;  // Default acceleration rate
+  memset(&_slew1, 0, sizeof(_slew1));
+  memset(&_slew2, 0, sizeof(_slew2));
+  memset(&_profile1, 0, sizeof(_profile1));
+  memset(&_profile2, 0, sizeof(_profile2));
+  setAcceleration(10);  // Default acceleration rate
   _lastUpdateTime = 0;
+  _lastRampTime = 0;
+  _moving1 = false;
+  _moving2 = false;
+  _moveStart1 = 0;
+  _moveStart2 = 0;
+  memset(&_state, 0, sizeof(_state));
+  memset(&_watch1, 0, sizeof(_watch1));
+  memset(&_watch2, 0, sizeof(_watch2));
+  _motionTolerance = 10;
+  _motionSamples = HT_MOTION_SAMPLES;
+  memset(&_speed1, 0, sizeof(_speed1));
+  memset(&_speed2, 0, sizeof(_speed2));
+  memset(&_velocity1, 0, sizeof(_velocity1));
+  memset(&_velocity2, 0, sizeof(_velocity2));
+  _asyncReadBusy = false;
+  _asyncWrites = 0;
+  _autoFlush = true;
+  invalidateShadow();
 }
 
 // Initialize the motor controller
 void HiTechnicMotor::begin() {
-  Wire.begin();
+  _bus->begin();
   delay(100); // Allow controller to initialize
   
+  // Controller state is unknown until every register has been written once
+  invalidateShadow();
+  
   // Set both motors to power mode by default
   setMotorMode(MOTOR_BOTH, MOTOR_MODE_POWER);
   
@@ -29,6 +66,9 @@ void HiTechnicMotor::begin() {
   
   // Reset encoders
   resetAllEncoders();
+  
+  // Settings above are only staged when auto flush is off
+  flush();
 }
 
 // Set motor power (-100 to 100)
@@ -40,40 +80,79 @@ void HiTechnicMotor::setMotorPower(uint8_t motor, int8_t power) {
   if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
     _motor1CurrentPower = power;
     _motor1TargetPower = power;
+    _slew1.power = (int16_t)power << 8;
+    _slew1.fraction = 0;
+    _profile1.active = false;
+    _moving1 = false;
+    _speed1.enabled = false;
   }
   if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
     _motor2CurrentPower = power;
     _motor2TargetPower = power;
+    _slew2.power = (int16_t)power << 8;
+    _slew2.fraction = 0;
+    _profile2.active = false;
+    _moving2 = false;
+    _speed2.enabled = false;
   }
   
   // Per spec: must set MODE before POWER for proper operation
   if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
-    writeRegister(HT_MOTOR1_MODE, MOTOR_MODE_POWER);  // Set to power control mode
-    writeRegister(HT_MOTOR1_POWER, (uint8_t)power);
+    setShadow(HT_MOTOR1_MODE, MOTOR_MODE_POWER);
+    setShadow(HT_MOTOR1_POWER, (uint8_t)power);
   }
   
   if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
-    writeRegister(HT_MOTOR2_MODE, MOTOR_MODE_POWER);  // Set to power control mode
-    writeRegister(HT_MOTOR2_POWER, (uint8_t)power);
+    setShadow(HT_MOTOR2_MODE, MOTOR_MODE_POWER);
+    setShadow(HT_MOTOR2_POWER, (uint8_t)power);
+  }
+  
+  if (_autoFlush) {
+    flush();
   }
 }
 
 // Set motor power with smooth acceleration ramping
-void HiTechnicMotor::setMotorPowerSmooth(uint8_t motor, int8_t power, uint8_t acceleration) {
+void HiTechnicMotor::setMotorPowerSmooth(uint8_t motor, int8_t power, uint8_t acceleration, uint8_t deceleration) {
   // Constrain power to valid range
   power = constrain(power, -100, 100);
   
+  // Store rates if provided (deceleration defaults to acceleration);
+  // shaped profiles below are sized from them. A rate left at 0 keeps
+  // each motor's own setting.
+  if (acceleration > 0 || deceleration > 0) {
+    for (uint8_t m = MOTOR_1; m <= MOTOR_2; m++) {
+      if (motor != m && motor != MOTOR_BOTH) {
+        continue;
+      }
+      HiTechnicSlew& slew = (m == MOTOR_2) ? _slew2 : _slew1;
+      uint16_t accelRate = slew.accelRate;
+      uint16_t decelRate = slew.decelRate;
+      if (acceleration > 0) {
+        accelRate = (uint16_t)constrain(acceleration, 1, 100) * (1000 / HT_MOTOR_RAMP_MS);
+        decelRate = accelRate;
+      }
+      if (deceleration > 0) {
+        decelRate = (uint16_t)constrain(deceleration, 1, 100) * (1000 / HT_MOTOR_RAMP_MS);
+      }
+      setRampRate(m, accelRate, decelRate);
+    }
+  }
+  
+  // A ramp starting from rest integrates from now, not from the last step
+  if (_motor1CurrentPower == _motor1TargetPower &&
+      _motor2CurrentPower == _motor2TargetPower) {
+    _lastRampTime = micros();
+  }
+  
   // Set target power - actual power will ramp to this value
   if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
     _motor1TargetPower = power;
+    buildProfile(_profile1, _slew1, _motor1CurrentPower, power);
   }
   if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
     _motor2TargetPower = power;
-  }
-  
-  // Store acceleration rate if provided
-  if (acceleration > 0) {
-    _acceleration = constrain(acceleration, 1, 100);
+    buildProfile(_profile2, _slew2, _motor2CurrentPower, power);
   }
 }
 
@@ -82,60 +161,319 @@ bool HiTechnicMotor::update() {
   unsigned long currentTime = millis();
   
   // Limit update rate to avoid overwhelming I2C bus
-  if (currentTime - _lastUpdateTime < 20) {  // Update every 20ms max
+  unsigned long elapsed = currentTime - _lastUpdateTime;
+  if (elapsed < HT_MOTOR_RAMP_MS) {
     return (_motor1CurrentPower != _motor1TargetPower || 
-            _motor2CurrentPower != _motor2TargetPower);
+            _motor2CurrentPower != _motor2TargetPower ||
+            _moving1 || _moving2);
+  }
+  
+  // Writes are due on a fixed 20 ms grid and a late call is made up by the
+  // next ones; the ramp itself is integrated over elapsed time, so its
+  // length does not depend on how often loop() runs.
+  // After a long pause (e.g. a new ramp) the grid restarts from now.
+  if (elapsed >= 5 * HT_MOTOR_RAMP_MS) {
+    _lastUpdateTime = currentTime;
+  } else {
+    _lastUpdateTime += HT_MOTOR_RAMP_MS;
+  }
+  bool stillRamping = stepRamp();
+  
+  // Speed PID on the same grid
+  if (_speed1.enabled || _speed2.enabled) {
+    stepSpeed((uint32_t)HT_MOTOR_RAMP_MS * 1000);
   }
+  checkMotion();
   
-  _lastUpdateTime = currentTime;
+  // Only bytes that changed go out; both motors stepping share one burst
+  if (_autoFlush) {
+    flush();
+  }
+  
+  return stillRamping;
+}
+
+// Advance both ramps by the time elapsed since the last step (staged in
+// the shadow only)
+bool HiTechnicMotor::stepRamp() {
+  unsigned long now = micros();
+  uint32_t elapsed = now - _lastRampTime;
+  _lastRampTime = now;
   bool stillRamping = false;
+  int8_t output;
   
   // Ramp Motor 1
-  if (_motor1CurrentPower != _motor1TargetPower) {
+  if (rampMotor(_slew1, _profile1, _motor1TargetPower, _motor1CurrentPower, elapsed, now, output)) {
     stillRamping = true;
-    
-    if (_motor1CurrentPower < _motor1TargetPower) {
-      _motor1CurrentPower += _acceleration;
-      if (_motor1CurrentPower > _motor1TargetPower) {
-        _motor1CurrentPower = _motor1TargetPower;
-      }
-    } else {
-      _motor1CurrentPower -= _acceleration;
-      if (_motor1CurrentPower < _motor1TargetPower) {
-        _motor1CurrentPower = _motor1TargetPower;
-      }
-    }
-    
-    writeRegister(HT_MOTOR1_MODE, MOTOR_MODE_POWER);
-    writeRegister(HT_MOTOR1_POWER, (uint8_t)_motor1CurrentPower);
+    setShadow(HT_MOTOR1_MODE, MOTOR_MODE_POWER);
+    setShadow(HT_MOTOR1_POWER, (uint8_t)output);
   }
   
   // Ramp Motor 2
-  if (_motor2CurrentPower != _motor2TargetPower) {
+  if (rampMotor(_slew2, _profile2, _motor2TargetPower, _motor2CurrentPower, elapsed, now, output)) {
     stillRamping = true;
-    
-    if (_motor2CurrentPower < _motor2TargetPower) {
-      _motor2CurrentPower += _acceleration;
-      if (_motor2CurrentPower > _motor2TargetPower) {
-        _motor2CurrentPower = _motor2TargetPower;
-      }
+    setShadow(HT_MOTOR2_MODE, MOTOR_MODE_POWER);
+    setShadow(HT_MOTOR2_POWER, (uint8_t)output);
+  }
+  
+  // Stream trajectory targets; both land in the 0x48-0x4F shadow range,
+  // so a flush writes them as one burst
+  if (stepTrajectory(_trajectory1, _moving1, _moveStart1, now, HT_ENCODER1_TARGET)) {
+    stillRamping = true;
+  }
+  if (stepTrajectory(_trajectory2, _moving2, _moveStart2, now, HT_ENCODER2_TARGET)) {
+    stillRamping = true;
+  }
+  
+  return stillRamping;
+}
+
+// Stage the target for now on a running trajectory; the final step
+// stages the exact goal and ends the move. Returns true while moving.
+bool HiTechnicMotor::stepTrajectory(HiTechnicTrajectory& trajectory, bool& moving,
+                                    unsigned long start, unsigned long now, uint8_t reg) {
+  if (!moving) {
+    return false;
+  }
+  
+  uint32_t elapsed = now - start;
+  if (elapsed >= trajectory.getDuration()) {
+    setShadow32(reg, trajectory.getGoal());
+    moving = false;
+    return false;
+  }
+  
+  setShadow32(reg, trajectory.position(elapsed));
+  return true;
+}
+
+// One ramp step for one motor: a table lookup for shaped profiles, the
+// slew integrator for linear ones. Sets output to the power register
+// value and returns true if the motor was ramping.
+bool HiTechnicMotor::rampMotor(HiTechnicSlew& slew, HiTechnicProfile& profile, int8_t target,
+                               int8_t& current, uint32_t elapsed, unsigned long now, int8_t& output) {
+  if (!profile.active) {
+    if (!slewStep(slew, target, elapsed)) {
+      return false;
+    }
+    current = slewPower(slew);
+    output = current;
+    return true;
+  }
+  
+  long t = (long)(now - profile.start);
+  if (t < 0) {
+    // Initial coast of the freewheel profile
+    output = MOTOR_FLOAT;
+    return true;
+  }
+  
+  if ((uint32_t)t >= profile.duration) {
+    output = profile.table[HT_PROFILE_STEPS];
+    profile.active = false;
+  } else {
+    uint32_t scaled = (uint32_t)t * HT_PROFILE_STEPS;
+    uint8_t index = scaled / profile.duration;
+    int8_t from = profile.table[index];
+    int8_t to = profile.table[index + 1];
+    output = from;
+    if (from != MOTOR_FLOAT && to != MOTOR_FLOAT) {
+      uint32_t fraction = (scaled - index * profile.duration) / ((profile.duration >> 8) + 1);
+      output = from + (int8_t)(((int16_t)(to - from) * (int16_t)fraction) / 256);
+    }
+  }
+  
+  // A coasting motor counts as stopped
+  current = (output == MOTOR_FLOAT) ? 0 : output;
+  slew.power = (int16_t)current << 8;
+  slew.fraction = 0;
+  return true;
+}
+
+// Precompute a shaped ramp from current to target. Linear profiles are
+// left to the slew integrator; shaped ones take as long as the linear
+// ramp would at the motor's accel/decel rates.
+void HiTechnicMotor::buildProfile(HiTechnicProfile& profile, const HiTechnicSlew& slew,
+                                  int8_t current, int8_t target) {
+  profile.active = false;
+  if (profile.type == HT_PROFILE_LINEAR || current == target) {
+    return;
+  }
+  
+  // Duration: down to zero at the decel rate on a reversal, then up at the
+  // accel rate; otherwise the whole change at one of them
+  uint16_t currentAbs = abs(current);
+  uint16_t targetAbs = abs(target);
+  uint32_t duration;
+  if ((current > 0 && target < 0) || (current < 0 && target > 0)) {
+    duration = currentAbs * 1000000UL / slew.decelRate +
+               targetAbs * 1000000UL / slew.accelRate;
+  } else if (targetAbs > currentAbs) {
+    duration = (targetAbs - currentAbs) * 1000000UL / slew.accelRate;
+  } else {
+    duration = (currentAbs - targetAbs) * 1000000UL / slew.decelRate;
+  }
+  
+  profile.start = micros();
+  profile.duration = (duration > 0) ? duration : 1;
+  
+  // Phase 1 of the freewheel profile: coast before a large drop
+  if (profile.type == HT_PROFILE_FREEWHEEL &&
+      currentAbs > HT_FREEWHEEL_ABOVE && targetAbs + HT_FREEWHEEL_DROP < currentAbs) {
+    profile.start += (uint32_t)HT_FREEWHEEL_MS * 1000UL;
+  }
+  
+  int16_t delta = (int16_t)target - current;
+  for (uint8_t i = 0; i <= HT_PROFILE_STEPS; i++) {
+    uint8_t shape;
+    if (profile.type == HT_PROFILE_EXPONENTIAL) {
+      shape = HT_SHAPE_EXPONENTIAL[i];
+    } else if (profile.type == HT_PROFILE_SCURVE) {
+      shape = HT_SHAPE_SCURVE[i];
     } else {
-      _motor2CurrentPower -= _acceleration;
-      if (_motor2CurrentPower < _motor2TargetPower) {
-        _motor2CurrentPower = _motor2TargetPower;
-      }
+      shape = (uint16_t)i * 255 / HT_PROFILE_STEPS;
     }
+    // The step spans up to 200 on a reversal, so it is kept in 16 bits
+    // (and the product in 32) until the sum is back within +/-100
+    int16_t power = current + (int16_t)(((int32_t)delta * shape) / 255);
+    power = constrain(power, -100, 100);
     
-    writeRegister(HT_MOTOR2_MODE, MOTOR_MODE_POWER);
-    writeRegister(HT_MOTOR2_POWER, (uint8_t)_motor2CurrentPower);
+    // Phase 3 of the freewheel profile: coast the last stretch to zero
+    if (profile.type == HT_PROFILE_FREEWHEEL && target == 0 &&
+        abs(power) < HT_FREEWHEEL_THRESHOLD) {
+      power = MOTOR_FLOAT;
+    }
+    profile.table[i] = power;
   }
   
-  return stillRamping;
+  profile.active = true;
+}
+
+// Convert power units per second into Q8.8 LSBs per microsecond << 16:
+// rate * 2^24 / 10^6, split as rate * 16 + rate * 97152 / 125000 so
+// nothing overflows 32 bits
+uint32_t HiTechnicMotor::slewRate(uint16_t unitsPerSecond) {
+  uint32_t rate = constrain(unitsPerSecond, 1, HT_SLEW_MAX_RATE);
+  return rate * 16UL + rate * 97152UL / 125000UL;
+}
+
+// Move slew.power toward target by the rate limit times elapsed.
+// Returns true if the power was not already at the target.
+bool HiTechnicMotor::slewStep(HiTechnicSlew& slew, int8_t target, uint32_t elapsed) {
+  int16_t goal = (int16_t)target << 8;
+  if (slew.power == goal) {
+    slew.fraction = 0;
+    return false;
+  }
+  
+  // Moving toward zero (including down to zero on a reversal) is
+  // deceleration, moving away from it acceleration
+  bool towardZero = (slew.power > 0 && goal < slew.power) ||
+                    (slew.power < 0 && goal > slew.power);
+  uint32_t rate = towardZero ? slew.decelStep : slew.accelStep;
+  
+  if (elapsed > HT_SLEW_MAX_ELAPSED_US) {
+    elapsed = HT_SLEW_MAX_ELAPSED_US;
+  }
+  
+  uint32_t step = 0;
+  while (elapsed > 0) {
+    uint32_t chunk = (elapsed > HT_SLEW_CHUNK_US) ? HT_SLEW_CHUNK_US : elapsed;
+    uint32_t scaled = rate * chunk + slew.fraction;
+    step += scaled >> 16;
+    slew.fraction = scaled & 0xFFFF;
+    elapsed -= chunk;
+  }
+  
+  // A reversal decelerates to zero first, then spends the rest of the
+  // elapsed time accelerating the other way
+  if (towardZero && ((slew.power > 0 && goal < 0) || (slew.power < 0 && goal > 0))) {
+    uint32_t distance = (slew.power > 0) ? slew.power : -slew.power;
+    if (step <= distance) {
+      slew.power += (slew.power > 0) ? -(int16_t)step : (int16_t)step;
+      return true;
+    }
+    
+    // Unused time past zero; more than a full-scale swing is never needed
+    uint32_t leftover = step - distance;
+    if (leftover > 51200UL) {
+      leftover = 51200UL;
+    }
+    slew.power = 0;
+    slew.fraction = 0;
+    slewStep(slew, target, (leftover << 16) / rate);
+    return true;
+  }
+  
+  int32_t power = slew.power;
+  if (power < goal) {
+    power = (power + (int32_t)step > goal) ? goal : power + (int32_t)step;
+  } else {
+    power = (power - (int32_t)step < goal) ? goal : power - (int32_t)step;
+  }
+  slew.power = (int16_t)power;
+  
+  if (slew.power == goal) {
+    slew.fraction = 0;
+  }
+  return true;
+}
+
+// Q8.8 power rounded to the nearest whole power unit
+int8_t HiTechnicMotor::slewPower(const HiTechnicSlew& slew) {
+  if (slew.power >= 0) {
+    return (int8_t)((slew.power + 128) >> 8);
+  }
+  return (int8_t)-((-slew.power + 128) >> 8);
 }
 
 // Set acceleration rate for smooth power changes
 void HiTechnicMotor::setAcceleration(uint8_t acceleration) {
-  _acceleration = constrain(acceleration, 1, 100);
+  uint16_t rate = (uint16_t)constrain(acceleration, 1, 100) * (1000 / HT_MOTOR_RAMP_MS);
+  setRampRate(MOTOR_BOTH, rate, rate);
+}
+
+// Set deceleration rate for smooth power changes
+void HiTechnicMotor::setDeceleration(uint8_t deceleration) {
+  uint16_t rate = (uint16_t)constrain(deceleration, 1, 100) * (1000 / HT_MOTOR_RAMP_MS);
+  setRampRate(MOTOR_1, _slew1.accelRate, rate);
+  setRampRate(MOTOR_2, _slew2.accelRate, rate);
+}
+
+// Set ramp limits in power units per second
+void HiTechnicMotor::setRampRate(uint8_t motor, uint16_t accelRate, uint16_t decelRate) {
+  accelRate = constrain(accelRate, 1, HT_SLEW_MAX_RATE);
+  decelRate = constrain(decelRate, 1, HT_SLEW_MAX_RATE);
+  
+  if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
+    _slew1.accelStep = slewRate(accelRate);
+    _slew1.decelStep = slewRate(decelRate);
+    _slew1.accelRate = accelRate;
+    _slew1.decelRate = decelRate;
+  }
+  if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
+    _slew2.accelStep = slewRate(accelRate);
+    _slew2.decelStep = slewRate(decelRate);
+    _slew2.accelRate = accelRate;
+    _slew2.decelRate = decelRate;
+  }
+}
+
+// Select the ramp shape used by future setMotorPowerSmooth() calls
+void HiTechnicMotor::setRampProfile(uint8_t motor, uint8_t profile) {
+  if (profile > HT_PROFILE_SCURVE) {
+    profile = HT_PROFILE_LINEAR;
+  }
+  if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
+    _profile1.type = profile;
+  }
+  if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
+    _profile2.type = profile;
+  }
+}
+
+uint8_t HiTechnicMotor::getRampProfile(uint8_t motor) {
+  return (motor == MOTOR_2) ? _profile2.type : _profile1.type;
 }
 
 // Get current target power
@@ -161,11 +499,15 @@ int8_t HiTechnicMotor::getCurrentPower(uint8_t motor) {
 // Set motor mode
 void HiTechnicMotor::setMotorMode(uint8_t motor, uint8_t mode) {
   if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
-    writeRegister(HT_MOTOR1_MODE, mode);
+    setShadow(HT_MOTOR1_MODE, mode);
   }
   
   if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
-    writeRegister(HT_MOTOR2_MODE, mode);
+    setShadow(HT_MOTOR2_MODE, mode);
+  }
+  
+  if (_autoFlush) {
+    flush();
   }
 }
 
@@ -181,14 +523,22 @@ void HiTechnicMotor::stopAll() {
 
 // Reset encoder
 void HiTechnicMotor::resetEncoder(uint8_t motor) {
+  // The reset needs both writes on the bus with a pause between them,
+  // so this always flushes immediately
   if (motor == MOTOR_1) {
-    writeRegister(HT_MOTOR1_MODE, MOTOR_MODE_RESET_ENCODER);
+    _velocity1.primed = false;
+    setShadow(HT_MOTOR1_MODE, MOTOR_MODE_RESET_ENCODER);
+    flush();
     delay(10);
-    writeRegister(HT_MOTOR1_MODE, MOTOR_MODE_POWER);
+    setShadow(HT_MOTOR1_MODE, MOTOR_MODE_POWER);
+    flush();
   } else if (motor == MOTOR_2) {
-    writeRegister(HT_MOTOR2_MODE, MOTOR_MODE_RESET_ENCODER);
+    _velocity2.primed = false;
+    setShadow(HT_MOTOR2_MODE, MOTOR_MODE_RESET_ENCODER);
+    flush();
     delay(10);
-    writeRegister(HT_MOTOR2_MODE, MOTOR_MODE_POWER);
+    setShadow(HT_MOTOR2_MODE, MOTOR_MODE_POWER);
+    flush();
   }
 }
 
@@ -198,25 +548,603 @@ void HiTechnicMotor::resetAllEncoders() {
   resetEncoder(MOTOR_2);
 }
 
-// Read encoder value
+// Read encoder value, timestamped at the middle of the transaction
 int32_t HiTechnicMotor::readEncoder(uint8_t motor) {
+  if (!sampleEncoder(motor)) {
+    return 0;
+  }
+  return (motor == MOTOR_1) ? _state.encoder1 : _state.encoder2;
+}
+
+// Read one encoder into the snapshot and the velocity filter
+// Returns false (snapshot unchanged) if the read failed
+bool HiTechnicMotor::sampleEncoder(uint8_t motor) {
+  if (motor != MOTOR_1 && motor != MOTOR_2) {
+    return false;
+  }
+  
+  uint8_t data[4];
+  waitForDevice();
+  unsigned long start = micros();
+  if (readRegisters((motor == MOTOR_1) ? HT_ENCODER1_CURRENT : HT_ENCODER2_CURRENT, data, 4) < 4) {
+    return false;
+  }
+  unsigned long time = start + (micros() - start) / 2;
+  
+  int32_t count = decode32(data);
+  if (motor == MOTOR_1) {
+    _state.encoder1 = count;
+    sampleVelocity(_velocity1, count, time);
+  } else {
+    _state.encoder2 = count;
+    sampleVelocity(_velocity2, count, time);
+  }
+  return true;
+}
+
+// Read the whole MODE1..ENCODER2 block in one transaction
+bool HiTechnicMotor::readState() {
+  uint8_t block[HT_MOTOR_STATE_LENGTH];
+  
+  // Time the transaction itself, not the wait for the write gap
+  waitForDevice();
+  unsigned long start = micros();
+  if (readRegisters(HT_MOTOR_STATE_START, block, HT_MOTOR_STATE_LENGTH) < HT_MOTOR_STATE_LENGTH) {
+    return false;  // Keep the previous snapshot
+  }
+  
+  decodeState(block, start + (micros() - start) / 2);
+  return true;
+}
+
+// Queue a snapshot read; the snapshot updates when it completes
+bool HiTechnicMotor::readStateAsync(volatile uint8_t* status) {
+  if (_asyncReadBusy || !usesAsyncBus() || !isReady()) {
+    return false;
+  }
+  
+  _asyncReadBusy = true;
+  if (!HTAsyncI2C.read(_address, HT_MOTOR_STATE_START, _asyncBlock, HT_MOTOR_STATE_LENGTH,
+                       onStateRead, this, status)) {
+    _asyncReadBusy = false;
+    return false;
+  }
+  return true;
+}
+
+// Queue an encoder read; getEncoder() returns it once complete
+bool HiTechnicMotor::readEncoderAsync(uint8_t motor, volatile uint8_t* status) {
+  if (_asyncReadBusy || !usesAsyncBus() || !isReady() || (motor != MOTOR_1 && motor != MOTOR_2)) {
+    return false;
+  }
+  
+  _asyncReadBusy = true;
+  bool queued;
+  if (motor == MOTOR_1) {
+    queued = HTAsyncI2C.read(_address, HT_ENCODER1_CURRENT, _asyncBlock, 4,
+                             onEncoder1Read, this, status);
+  } else {
+    queued = HTAsyncI2C.read(_address, HT_ENCODER2_CURRENT, _asyncBlock, 4,
+                             onEncoder2Read, this, status);
+  }
+  
+  if (!queued) {
+    _asyncReadBusy = false;
+  }
+  return queued;
+}
+
+// Check if an async read is still in flight
+bool HiTechnicMotor::isAsyncBusy() {
+  return _asyncReadBusy;
+}
+
+// Async completion handlers (run from HTAsyncI2C.poll())
+void HiTechnicMotor::onStateRead(void* context, uint8_t status) {
+  HiTechnicMotor* motor = (HiTechnicMotor*)context;
+  if (status == HT_ASYNC_OK) {
+    motor->decodeState(motor->_asyncBlock, micros());
+  }
+  motor->_asyncReadBusy = false;
+}
+
+void HiTechnicMotor::onEncoder1Read(void* context, uint8_t status) {
+  HiTechnicMotor* motor = (HiTechnicMotor*)context;
+  if (status == HT_ASYNC_OK) {
+    motor->_state.encoder1 = decode32(motor->_asyncBlock);
+    sampleVelocity(motor->_velocity1, motor->_state.encoder1, micros());
+  }
+  motor->_asyncReadBusy = false;
+}
+
+void HiTechnicMotor::onEncoder2Read(void* context, uint8_t status) {
+  HiTechnicMotor* motor = (HiTechnicMotor*)context;
+  if (status == HT_ASYNC_OK) {
+    motor->_state.encoder2 = decode32(motor->_asyncBlock);
+    sampleVelocity(motor->_velocity2, motor->_state.encoder2, micros());
+  }
+  motor->_asyncReadBusy = false;
+}
+
+// The write gap starts when the write leaves the bus, not when it is queued
+void HiTechnicMotor::onWrite(void* context, uint8_t) {
+  HiTechnicMotor* motor = (HiTechnicMotor*)context;
+  motor->_lastWriteTime = micros();
+  motor->_asyncWrites--;
+}
+
+// Unpack a MODE1..ENCODER2 register block into the snapshot
+void HiTechnicMotor::decodeState(const uint8_t* block, unsigned long time) {
+  _state.mode1 = block[0];
+  _state.power1 = (int8_t)block[1];
+  _state.power2 = (int8_t)block[2];
+  _state.mode2 = block[3];
+  _state.target1 = decode32(block + 4);
+  _state.target2 = decode32(block + 8);
+  _state.encoder1 = decode32(block + 12);
+  _state.encoder2 = decode32(block + 16);
+  sampleVelocity(_velocity1, _state.encoder1, time);
+  sampleVelocity(_velocity2, _state.encoder2, time);
+}
+
+// Alpha-beta filter step: predict the position from the velocity, then
+// correct both by the residual. Multiplies and one 32-bit divide; time is
+// taken in 16 us units so the products stay within 32 bits.
+void HiTechnicMotor::sampleVelocity(HiTechnicVelocity& filter, int32_t count, unsigned long time) {
+  uint32_t dt = time - filter.time;
+  
+  if (!filter.primed || dt > HT_VELOCITY_MAX_DT_US) {
+    // First sample, or too long since the last one to filter: restart
+    // from the slope between the two (zero for the first). dt is past
+    // HT_VELOCITY_MAX_DT_US here, so dropping its low 8 bits costs little,
+    // and the clamp on the count keeps the Q20 numerator within 32 bits.
+    int32_t scaled = (int32_t)(dt >> 8);
+    if (filter.primed && scaled > 0) {
+      int32_t delta = constrain(count - filter.count, -524287L, 524287L);
+      filter.velocity = constrain((delta * 4096) / scaled, -131071L, 131071L);
+    } else {
+      filter.velocity = 0;
+    }
+    filter.count = count;
+    filter.time = time;
+    filter.offset = 0;
+    filter.primed = true;
+    return;
+  }
+  
+  int32_t dt16 = dt >> 4;
+  if (dt16 == 0) {
+    return;  // Same instant as the last sample
+  }
+  
+  // Residual (Q8): measured motion minus predicted motion
+  int32_t predicted = filter.offset + ((filter.velocity * dt16) >> 8);
+  int32_t residual = (count - filter.count) * 256 - predicted;
+  residual = constrain(residual, -8000000L, 8000000L);
+  
+  // New estimate relative to the new sample: predicted + alpha * r - count
+  filter.offset = -(residual * (256 - HT_VELOCITY_ALPHA)) / 256;
+  filter.velocity += (residual * HT_VELOCITY_BETA) / dt16;
+  filter.velocity = constrain(filter.velocity, -131071L, 131071L);
+  
+  filter.count = count;
+  filter.time = time;
+}
+
+// Get last snapshot
+const HiTechnicMotorState& HiTechnicMotor::getState() {
+  return _state;
+}
+
+// Get encoder value from last snapshot
+int32_t HiTechnicMotor::getEncoder(uint8_t motor) {
   if (motor == MOTOR_1) {
-    return readRegister32(HT_ENCODER1_CURRENT);
+    return _state.encoder1;
   } else if (motor == MOTOR_2) {
-    return readRegister32(HT_ENCODER2_CURRENT);
+    return _state.encoder2;
   }
   return 0;
 }
 
+// Timestamp of the last encoder sample
+unsigned long HiTechnicMotor::getEncoderTime(uint8_t motor) {
+  if (motor == MOTOR_1) {
+    return _velocity1.time;
+  } else if (motor == MOTOR_2) {
+    return _velocity2.time;
+  }
+  return 0;
+}
+
+// Filtered encoder velocity in counts per second
+int32_t HiTechnicMotor::getVelocity(uint8_t motor) {
+  int32_t velocity;
+  if (motor == MOTOR_1) {
+    velocity = _velocity1.velocity;
+  } else if (motor == MOTOR_2) {
+    velocity = _velocity2.velocity;
+  } else {
+    return 0;
+  }
+  // Q20 counts per microsecond to counts per second: * 10^6 / 2^20
+  return (velocity * 15625) / 16384;
+}
+
 // Set target position for position control mode
 void HiTechnicMotor::setTargetPosition(uint8_t motor, int32_t target) {
+  // A direct target replaces any trajectory being streamed
   if (motor == MOTOR_1) {
-    writeRegister32(HT_ENCODER1_TARGET, target);
+    _moving1 = false;
+    setShadow32(HT_ENCODER1_TARGET, target);
   } else if (motor == MOTOR_2) {
-    writeRegister32(HT_ENCODER2_TARGET, target);
+    _moving2 = false;
+    setShadow32(HT_ENCODER2_TARGET, target);
+  }
+  
+  if (_autoFlush) {
+    flush();
   }
 }
 
+// Hold a speed with the host-side PID
+void HiTechnicMotor::setTargetVelocity(uint8_t motor, int16_t velocity) {
+  if (motor != MOTOR_1 && motor != MOTOR_2) {
+    return;
+  }
+  
+  HiTechnicSpeedLoop& loop = (motor == MOTOR_1) ? _speed1 : _speed2;
+  loop.target = constrain(velocity, -HT_SPEED_MAX_ERROR, HT_SPEED_MAX_ERROR);
+  if (loop.enabled) {
+    return;  // Keep the integral so a new target does not bump the output
+  }
+  
+  // Take over from ramps and trajectories, starting from the power the
+  // motor already has
+  loop.enabled = true;
+  if (motor == MOTOR_1) {
+    loop.integral = (int32_t)_motor1CurrentPower << 16;
+    loop.lastVelocity = getVelocity(MOTOR_1);
+    _motor1TargetPower = _motor1CurrentPower;
+    _profile1.active = false;
+    _moving1 = false;
+    setShadow(HT_MOTOR1_MODE, MOTOR_MODE_POWER);
+  } else {
+    loop.integral = (int32_t)_motor2CurrentPower << 16;
+    loop.lastVelocity = getVelocity(MOTOR_2);
+    _motor2TargetPower = _motor2CurrentPower;
+    _profile2.active = false;
+    _moving2 = false;
+    setShadow(HT_MOTOR2_MODE, MOTOR_MODE_POWER);
+  }
+  loop.integral -= (int32_t)loop.kf * loop.target;
+  
+  if (_autoFlush) {
+    flush();
+  }
+}
+
+// Set speed PID gains
+void HiTechnicMotor::setSpeedGains(uint8_t motor, uint16_t kp, uint16_t ki, uint16_t kd, uint16_t kf) {
+  if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
+    _speed1.kp = kp;
+    _speed1.ki = ki;
+    _speed1.kd = kd;
+    _speed1.kf = kf;
+    _speed1.period = 0;  // Refold ki and kd on the next step
+  }
+  if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
+    _speed2.kp = kp;
+    _speed2.ki = ki;
+    _speed2.kd = kd;
+    _speed2.kf = kf;
+    _speed2.period = 0;
+  }
+}
+
+// Check if the speed PID is driving a motor
+bool HiTechnicMotor::isSpeedControlled(uint8_t motor) {
+  if (motor == MOTOR_1) {
+    return _speed1.enabled;
+  } else if (motor == MOTOR_2) {
+    return _speed2.enabled;
+  }
+  return _speed1.enabled || _speed2.enabled;
+}
+
+// One speed PID step: both velocities come from a single snapshot and
+// both powers are staged together, so the flush writes one burst
+bool HiTechnicMotor::stepSpeed(uint32_t period) {
+  if (!_speed1.enabled && !_speed2.enabled) {
+    return false;
+  }
+  if (!readState()) {
+    return false;
+  }
+  
+  if (_speed1.enabled) {
+    int8_t power = speedStep(_speed1, getVelocity(MOTOR_1), period);
+    _motor1CurrentPower = _motor1TargetPower = power;
+    _slew1.power = (int16_t)power << 8;
+    _slew1.fraction = 0;
+    setShadow(HT_MOTOR1_POWER, (uint8_t)power);
+  }
+  if (_speed2.enabled) {
+    int8_t power = speedStep(_speed2, getVelocity(MOTOR_2), period);
+    _motor2CurrentPower = _motor2TargetPower = power;
+    _slew2.power = (int16_t)power << 8;
+    _slew2.fraction = 0;
+    setShadow(HT_MOTOR2_POWER, (uint8_t)power);
+  }
+  return true;
+}
+
+// PID with feed-forward, all in Q16 power. The derivative acts on the
+// measured velocity so target changes do not kick; the integral stops
+// accumulating while the output is saturated in the same direction and
+// is clamped to the power range (anti-windup).
+int8_t HiTechnicMotor::speedStep(HiTechnicSpeedLoop& loop, int32_t velocity, uint32_t period) {
+  const int32_t limit = (int32_t)100 << 16;
+  
+  if (loop.period != period && period > 0) {
+    // kiStep = ki * period / 10^6 in Q24; kdStep = kd * 10^6 / period
+    loop.kiStep = (int32_t)(((uint32_t)loop.ki * (period >> 4)) / 3906UL) << 4;
+    loop.kdStep = (int32_t)loop.kd * (int32_t)(1000000UL / period);
+    loop.iLimit = (loop.kiStep > 0) ? 0x7FFFFFFFL / loop.kiStep : HT_SPEED_MAX_ERROR;
+    loop.dLimit = (loop.kdStep > 0) ? 0x7FFFFFFFL / loop.kdStep : HT_SPEED_MAX_ERROR;
+    loop.period = period;
+  }
+  
+  velocity = constrain(velocity, -HT_SPEED_MAX_ERROR, HT_SPEED_MAX_ERROR);
+  int32_t error = constrain((int32_t)loop.target - velocity, -HT_SPEED_MAX_ERROR, HT_SPEED_MAX_ERROR);
+  int32_t change = constrain(velocity - loop.lastVelocity, -loop.dLimit, loop.dLimit);
+  loop.lastVelocity = velocity;
+  
+  int32_t output = (int32_t)loop.kf * loop.target + (int32_t)loop.kp * error;
+  output = constrain(output, -limit, limit) - constrain(loop.kdStep * change, -limit, limit);
+  
+  // Past iLimit the product would overflow; one such step already
+  // saturates the integral
+  int32_t step = (loop.kiStep * constrain(error, -loop.iLimit, loop.iLimit)) >> 8;
+  bool saturated = (output + loop.integral >= limit && error > 0) ||
+                   (output + loop.integral <= -limit && error < 0);
+  if (!saturated) {
+    loop.integral = constrain(loop.integral + step, -limit, limit);
+  }
+  
+  output = constrain(output + loop.integral, -limit, limit);
+  return (int8_t)((output + ((int32_t)1 << 15)) >> 16);
+}
+
+// Set trajectory limits for future moveTo() calls
+void HiTechnicMotor::setTrajectoryLimits(uint8_t motor, uint32_t velocity, uint32_t acceleration, uint32_t jerk) {
+  if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
+    _trajectory1.setLimits(velocity, acceleration, jerk);
+  }
+  if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
+    _trajectory2.setLimits(velocity, acceleration, jerk);
+  }
+}
+
+// Start a jerk-limited move to goal in position mode
+bool HiTechnicMotor::moveTo(uint8_t motor, int32_t goal) {
+  if (motor != MOTOR_1 && motor != MOTOR_2) {
+    return false;
+  }
+  
+  HiTechnicTrajectory& trajectory = (motor == MOTOR_1) ? _trajectory1 : _trajectory2;
+  bool& moving = (motor == MOTOR_1) ? _moving1 : _moving2;
+  unsigned long& start = (motor == MOTOR_1) ? _moveStart1 : _moveStart2;
+  unsigned long now = micros();
+  
+  // Continue from the target being streamed, otherwise from the encoder
+  int32_t from;
+  if (moving) {
+    from = trajectory.position(now - start);
+  } else if (sampleEncoder(motor)) {
+    from = (motor == MOTOR_1) ? _state.encoder1 : _state.encoder2;
+  } else {
+    return false;  // Unknown start point: leave the motor as it is
+  }
+  
+  trajectory.plan(from, goal);
+  
+  // First target is the start point, so enabling position mode does not
+  // jump toward an old target (flush() sends it no later than the mode)
+  stageTarget(motor, from, MOTOR_MODE_POSITION, HT_TRAJECTORY_POWER);
+  start = now;
+  moving = true;
+  
+  if (_autoFlush) {
+    flush();
+  }
+  return true;
+}
+
+// Write modes, power limits and both targets in one burst
+void HiTechnicMotor::setTargets(int32_t target1, int32_t target2, uint8_t mode, int8_t power) {
+  power = constrain(power, -100, 100);
+  stageTarget(MOTOR_1, target1, mode, power);
+  stageTarget(MOTOR_2, target2, mode, power);
+  
+  // Rewrite the whole 0x44-0x4F block, unchanged bytes included, so both
+  // motors latch their new setpoints from the same transaction
+  _shadowDirty |= ((uint16_t)1 << HT_MOTOR_SHADOW_SIZE) - 1;
+  
+  if (_autoFlush) {
+    flush();
+  }
+}
+
+// Stage a target from an external planner in position mode
+void HiTechnicMotor::streamTarget(uint8_t motor, int32_t target) {
+  if (motor != MOTOR_1 && motor != MOTOR_2) {
+    return;
+  }
+  
+  stageTarget(motor, target, MOTOR_MODE_POSITION, HT_TRAJECTORY_POWER);
+  if (_autoFlush) {
+    flush();
+  }
+}
+
+// Stage mode, power and target for one motor, taking it over from ramps,
+// the speed loop and its own trajectory. Repeated calls only move the
+// target; the shadow filters out the unchanged MODE and POWER.
+// In position mode POWER only caps the speed, so the ramps and the speed
+// loop take over later from rest rather than from the cap.
+void HiTechnicMotor::stageTarget(uint8_t motor, int32_t target, uint8_t mode, int8_t power) {
+  int8_t output = (mode == MOTOR_MODE_POSITION) ? 0 : power;
+  HiTechnicSlew& slew = (motor == MOTOR_1) ? _slew1 : _slew2;
+  slew.power = (int16_t)output << 8;
+  slew.fraction = 0;
+  if (motor == MOTOR_1) {
+    _motor1CurrentPower = _motor1TargetPower = output;
+    _profile1.active = false;
+    _speed1.enabled = false;
+    _moving1 = false;
+    setShadow32(HT_ENCODER1_TARGET, target);
+    setShadow(HT_MOTOR1_MODE, mode);
+    setShadow(HT_MOTOR1_POWER, (uint8_t)power);
+  } else {
+    _motor2CurrentPower = _motor2TargetPower = output;
+    _profile2.active = false;
+    _speed2.enabled = false;
+    _moving2 = false;
+    setShadow32(HT_ENCODER2_TARGET, target);
+    setShadow(HT_MOTOR2_MODE, mode);
+    setShadow(HT_MOTOR2_POWER, (uint8_t)power);
+  }
+}
+
+// Check if a trajectory is still being streamed
+bool HiTechnicMotor::isMoving(uint8_t motor) {
+  if (motor == MOTOR_1) {
+    return _moving1;
+  } else if (motor == MOTOR_2) {
+    return _moving2;
+  }
+  return _moving1 || _moving2;
+}
+
+// Write every shadow register that changed since the last flush
+void HiTechnicMotor::flush() {
+  if (_shadowDirty == 0) {
+    // Nothing to write; a read keeps the controller's 2.5 s I2C timeout fed
+    if (millis() - _lastAccessTime >= HT_MOTOR_KEEPALIVE_MS) {
+      readState();
+    }
+    return;
+  }
+  
+  flushShadow(false);
+}
+
+// Queue every changed shadow register on the async engine
+bool HiTechnicMotor::flushAsync() {
+  if (!usesAsyncBus() || !isReady()) {
+    return false;
+  }
+  return flushShadow(true);
+}
+
+// The async engine drives the hardware TWI behind the global Wire only
+bool HiTechnicMotor::usesAsyncBus() {
+  return _bus == &HTWireBus;
+}
+
+// Write dirty shadow registers, blocking or through the async queue
+// Returns false if the async queue filled up (remaining bytes stay dirty)
+bool HiTechnicMotor::flushShadow(bool async) {
+  // A new target has to reach the controller no later than the mode that
+  // acts on it, or position mode briefly chases the old target. Marking
+  // the known bytes in between dirty makes mode and target one burst; if
+  // one of them is unknown, the target goes out first.
+  for (uint8_t motor = MOTOR_1; motor <= MOTOR_2; motor++) {
+    uint8_t modeReg = (motor == MOTOR_1) ? HT_MOTOR1_MODE : HT_MOTOR2_MODE;
+    uint8_t targetReg = (motor == MOTOR_1) ? HT_ENCODER1_TARGET : HT_ENCODER2_TARGET;
+    uint16_t modeBit = shadowBit(modeReg);
+    uint16_t targetBits = shadowBit(targetReg) * 0x0F;
+    if (!(_shadowDirty & modeBit) || !(_shadowDirty & targetBits)) {
+      continue;
+    }
+    
+    uint16_t span = (uint16_t)((shadowBit(targetReg) << 4) - modeBit);  // Mode through target
+    if (((_shadowValid | _shadowDirty) & span) == span) {
+      _shadowDirty |= span;
+    } else if (!writeShadowRange(targetReg - HT_MOTOR_SHADOW_START, 4, async)) {
+      return false;
+    }
+  }
+  
+  // When motor 2 changes on its own, MODE2 (0x47) has to go ahead of
+  // POWER2 (0x46) rather than after it in an ascending burst. A target
+  // merged with MODE2 above goes in the same burst.
+  uint16_t mode2Bit = shadowBit(HT_MOTOR2_MODE);
+  uint16_t power2Bit = shadowBit(HT_MOTOR2_POWER);
+  if ((_shadowDirty & mode2Bit) && (_shadowDirty & power2Bit) &&
+      !(_shadowDirty & shadowBit(HT_MOTOR1_MODE))) {
+    uint8_t first = HT_MOTOR2_MODE - HT_MOTOR_SHADOW_START;
+    uint8_t length = 1;
+    while (first + length < HT_MOTOR_SHADOW_SIZE &&
+           (_shadowDirty & ((uint16_t)1 << (first + length)))) {
+      length++;
+    }
+    if (!writeShadowRange(first, length, async)) {
+      return false;
+    }
+  }
+  
+  // Merge dirty bytes into as few bursts as possible. Short runs of clean
+  // bytes are bridged (rewritten with their known value) when that is
+  // cheaper than starting another transaction.
+  uint8_t i = 0;
+  while (i < HT_MOTOR_SHADOW_SIZE) {
+    if (!(_shadowDirty & ((uint16_t)1 << i))) {
+      i++;
+      continue;
+    }
+    
+    uint8_t last = i;
+    uint8_t j = i + 1;
+    while (j < HT_MOTOR_SHADOW_SIZE) {
+      uint16_t mask = (uint16_t)1 << j;
+      if (_shadowDirty & mask) {
+        last = j;
+      } else if (!(_shadowValid & mask) || j - last > HT_MOTOR_SHADOW_MERGE_GAP) {
+        break;
+      }
+      j++;
+    }
+    
+    if (!writeShadowRange(i, last - i + 1, async)) {
+      return false;
+    }
+    i = last + 1;
+  }
+  
+  return true;
+}
+
+// Choose whether setters write immediately or wait for flush()
+void HiTechnicMotor::setAutoFlush(bool enabled) {
+  _autoFlush = enabled;
+}
+
+bool HiTechnicMotor::getAutoFlush() {
+  return _autoFlush;
+}
+
+// Check if any shadow register is waiting to be written
+bool HiTechnicMotor::hasPendingWrites() {
+  return _shadowDirty != 0;
+}
+
+// Forget what the controller holds so the next flush rewrites everything
+void HiTechnicMotor::invalidateShadow() {
+  _shadowValid = 0;
+  _shadowDirty = 0;
+}
+
 // Read firmware version
 uint8_t HiTechnicMotor::readVersion() {
   return readRegister(HT_MOTOR_VERSION);
@@ -246,69 +1174,235 @@ uint8_t HiTechnicMotor::getI2CAddress() {
 
 // Check if motor is at target position
 bool HiTechnicMotor::isAtTarget(uint8_t motor, int32_t tolerance) {
-  int32_t current = readEncoder(motor);
-  int32_t target;
-  
-  if (motor == MOTOR_1) {
-    target = readRegister32(HT_ENCODER1_TARGET);
-  } else if (motor == MOTOR_2) {
-    target = readRegister32(HT_ENCODER2_TARGET);
-  } else {
+  if (motor != MOTOR_1 && motor != MOTOR_2) {
+    return false;
+  }
+  if (isMoving(motor)) {
     return false;
   }
   
-  return abs(current - target) <= tolerance;
+  // The target is known locally, so only the encoder is read
+  int32_t target = getTargetPosition(motor);
+  int32_t error = readEncoder(motor) - target;
+  return abs(error) <= tolerance;
 }
 
-// Write single byte to register
-void HiTechnicMotor::writeRegister(uint8_t reg, uint8_t value) {
-  Wire.beginTransmission(_address);
-  Wire.write(reg);
-  Wire.write(value);
-  Wire.endTransmission();
-  delay(1); // Small delay for I2C
+// Position target from the shadow (or the trajectory goal)
+int32_t HiTechnicMotor::getTargetPosition(uint8_t motor) {
+  if (motor != MOTOR_1 && motor != MOTOR_2) {
+    return 0;
+  }
+  if (isMoving(motor)) {
+    return (motor == MOTOR_1) ? _trajectory1.getGoal() : _trajectory2.getGoal();
+  }
+  
+  int32_t target;
+  if (!cachedTarget(motor, target)) {
+    // Never written by this class: the controller's own value
+    readState();
+    target = (motor == MOTOR_1) ? _state.target1 : _state.target2;
+  }
+  return target;
 }
 
-// Write 32-bit value to register (big-endian)
-void HiTechnicMotor::writeRegister32(uint8_t reg, int32_t value) {
-  Wire.beginTransmission(_address);
-  Wire.write(reg);
-  Wire.write((uint8_t)((value >> 24) & 0xFF)); // MSB
-  Wire.write((uint8_t)((value >> 16) & 0xFF));
-  Wire.write((uint8_t)((value >> 8) & 0xFF));
-  Wire.write((uint8_t)(value & 0xFF));         // LSB
-  Wire.endTransmission();
-  delay(1);
+// Target bytes as staged or written, false if any byte is unknown
+bool HiTechnicMotor::cachedTarget(uint8_t motor, int32_t& target) {
+  uint8_t reg = (motor == MOTOR_1) ? HT_ENCODER1_TARGET : HT_ENCODER2_TARGET;
+  uint8_t index = reg - HT_MOTOR_SHADOW_START;
+  uint16_t mask = (uint16_t)0x0F << index;
+  if (((_shadowValid | _shadowDirty) & mask) != mask) {
+    return false;
+  }
+  target = decode32(_shadow + index);
+  return true;
 }
 
-// Read single byte from register
-uint8_t HiTechnicMotor::readRegister(uint8_t reg) {
-  Wire.beginTransmission(_address);
-  Wire.write(reg);
-  Wire.endTransmission();
+// Register a motion-complete callback
+void HiTechnicMotor::onMotionComplete(uint8_t motor, HiTechnicMotionCallback callback, void* context) {
+  if (motor == MOTOR_1 || motor == MOTOR_BOTH) {
+    _watch1.callback = callback;
+    _watch1.context = context;
+    _watch1.count = 0;
+    _watch1.armed = true;
+    cachedTarget(MOTOR_1, _watch1.target);
+  }
+  if (motor == MOTOR_2 || motor == MOTOR_BOTH) {
+    _watch2.callback = callback;
+    _watch2.context = context;
+    _watch2.count = 0;
+    _watch2.armed = true;
+    cachedTarget(MOTOR_2, _watch2.target);
+  }
+}
+
+void HiTechnicMotor::setMotionTolerance(int32_t tolerance, uint8_t samples) {
+  _motionTolerance = tolerance;
+  _motionSamples = (samples > 0) ? samples : 1;
+}
+
+// Read one snapshot for both watches, only if either is waiting
+bool HiTechnicMotor::checkMotion() {
+  bool pending1 = watchPending(_watch1, MOTOR_1);
+  bool pending2 = watchPending(_watch2, MOTOR_2);
+  if (!pending1 && !pending2) {
+    return false;
+  }
+  if (!readState()) {
+    return false;
+  }
   
-  Wire.requestFrom(_address, (uint8_t)1);
-  if (Wire.available()) {
-    return Wire.read();
+  if (pending1) {
+    advanceWatch(_watch1, MOTOR_1, _state.encoder1);
   }
-  return 0;
+  if (pending2) {
+    advanceWatch(_watch2, MOTOR_2, _state.encoder2);
+  }
+  return true;
 }
 
-// Read 32-bit value from register (big-endian)
-int32_t HiTechnicMotor::readRegister32(uint8_t reg) {
-  Wire.beginTransmission(_address);
-  Wire.write(reg);
-  Wire.endTransmission();
+// A watch needs samples while it has a callback, the motor holds a
+// position target, and that target has not been reached yet (a changed
+// target re-arms it)
+bool HiTechnicMotor::watchPending(HiTechnicMotionWatch& watch, uint8_t motor) {
+  if (watch.callback == NULL || isMoving(motor)) {
+    return false;
+  }
+  uint8_t modeReg = (motor == MOTOR_1) ? HT_MOTOR1_MODE : HT_MOTOR2_MODE;
+  if (!((_shadowValid | _shadowDirty) & shadowBit(modeReg)) ||
+      _shadow[modeReg - HT_MOTOR_SHADOW_START] != MOTOR_MODE_POSITION) {
+    return false;
+  }
+  int32_t target;
+  if (!cachedTarget(motor, target)) {
+    return false;
+  }
   
-  Wire.requestFrom(_address, (uint8_t)4);
+  if (target != watch.target) {
+    watch.target = target;
+    watch.count = 0;
+    watch.armed = true;
+  }
+  return watch.armed;
+}
+
+// Count one sample; fire after enough in a row within tolerance
+void HiTechnicMotor::advanceWatch(HiTechnicMotionWatch& watch, uint8_t motor, int32_t encoder) {
+  if (abs(encoder - watch.target) > _motionTolerance) {
+    watch.count = 0;
+    return;
+  }
+  if (++watch.count < _motionSamples) {
+    return;
+  }
+  
+  // Disarm first: the callback may set a new target
+  watch.armed = false;
+  watch.callback(watch.context, motor);
+}
+
+// Check if the controller has finished its post-write gap
+bool HiTechnicMotor::isReady() {
+  return _asyncWrites == 0 && micros() - _lastWriteTime >= HT_I2C_WRITE_GAP_US;
+}
+
+// Wait out the remainder of the post-write gap for this controller only.
+// The earliest next access is _lastWriteTime + HT_I2C_WRITE_GAP_US; the
+// unsigned difference keeps the check correct across micros() rollover.
+// On the Wire bus, queued async transactions are finished first so they
+// never overlap a blocking one.
+void HiTechnicMotor::waitForDevice() {
+  if (usesAsyncBus()) {
+    HTAsyncI2C.waitIdle();
+  }
+  while (!isReady()) {
+    yield();
+  }
+  _lastAccessTime = millis();
+}
+
+// Write single byte to register
+void HiTechnicMotor::writeRegister(uint8_t reg, uint8_t value) {
+  waitForDevice();
+  _bus->beginTransmission(_address);
+  _bus->write(reg);
+  _bus->write(value);
+  _bus->endTransmission();
+  _lastWriteTime = micros();
+}
+
+// Stage a register in the shadow file, marking it dirty only if it changed
+void HiTechnicMotor::setShadow(uint8_t reg, uint8_t value) {
+  uint8_t index = reg - HT_MOTOR_SHADOW_START;
+  uint16_t mask = (uint16_t)1 << index;
   
-  int32_t value = 0;
-  if (Wire.available() >= 4) {
-    value = (int32_t)Wire.read() << 24; // MSB
-    value |= (int32_t)Wire.read() << 16;
-    value |= (int32_t)Wire.read() << 8;
-    value |= (int32_t)Wire.read();      // LSB
+  if (!(_shadowValid & mask) || _shadow[index] != value) {
+    _shadow[index] = value;
+    _shadowDirty |= mask;
+  }
+}
+
+// Stage a 32-bit register (big-endian) in the shadow file
+void HiTechnicMotor::setShadow32(uint8_t reg, int32_t value) {
+  setShadow(reg, (uint8_t)((value >> 24) & 0xFF)); // MSB
+  setShadow(reg + 1, (uint8_t)((value >> 16) & 0xFF));
+  setShadow(reg + 2, (uint8_t)((value >> 8) & 0xFF));
+  setShadow(reg + 3, (uint8_t)(value & 0xFF));     // LSB
+}
+
+// Mask bit for a register in the shadow file
+uint16_t HiTechnicMotor::shadowBit(uint8_t reg) {
+  return (uint16_t)1 << (reg - HT_MOTOR_SHADOW_START);
+}
+
+// Burst-write part of the shadow file and mark it clean
+bool HiTechnicMotor::writeShadowRange(uint8_t index, uint8_t length, bool async) {
+  if (async) {
+    _asyncWrites++;
+    if (!HTAsyncI2C.write(_address, HT_MOTOR_SHADOW_START + index, _shadow + index, length,
+                          onWrite, this)) {
+      _asyncWrites--;
+      return false;
+    }
+  } else {
+    writeRegisters(HT_MOTOR_SHADOW_START + index, _shadow + index, length);
   }
   
+  uint16_t mask = (uint16_t)(((uint32_t)1 << (index + length)) - ((uint32_t)1 << index));
+  _shadowValid |= mask;
+  _shadowDirty &= ~mask;
+  return true;
+}
+
+// Write consecutive registers in one auto-incrementing transaction
+void HiTechnicMotor::writeRegisters(uint8_t reg, const uint8_t* data, uint8_t length) {
+  waitForDevice();
+  _bus->beginTransmission(_address);
+  _bus->write(reg);
+  for (uint8_t i = 0; i < length; i++) {
+    _bus->write(data[i]);
+  }
+  _bus->endTransmission();
+  _lastWriteTime = micros();
+}
+
+// Read single byte from register
+uint8_t HiTechnicMotor::readRegister(uint8_t reg) {
+  uint8_t value = 0;
+  readRegisters(reg, &value, 1);
   return value;
 }
+
+// Read consecutive registers in one repeated-START transaction, returns
+// bytes received
+uint8_t HiTechnicMotor::readRegisters(uint8_t reg, uint8_t* data, uint8_t length) {
+  waitForDevice();
+  return _bus->writeThenRead(_address, reg, data, length);
+}
+
+// Decode big-endian 32-bit value from a register block
+int32_t HiTechnicMotor::decode32(const uint8_t* data) {
+  return ((int32_t)data[0] << 24) |
+         ((int32_t)data[1] << 16) |
+         ((int32_t)data[2] << 8) |
+         (int32_t)data[3];
+}
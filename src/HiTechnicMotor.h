@@ -13,7 +13,9 @@
 #define HiTechnicMotor_h
 
 #include "Arduino.h"
-#include <Wire.h>
+#include "HiTechnicBus.h"
+#include "HiTechnicAsyncI2C.h"
+#include "HiTechnicTrajectory.h"
 
 // Register addresses for HiTechnic Motor Controller
 #define HT_MOTOR_VERSION      0x00  // Version number
@@ -30,6 +32,88 @@
 #define HT_ENCODER1_CURRENT   0x50  // Motor 1 current encoder (4 bytes)
 #define HT_ENCODER2_CURRENT   0x54  // Motor 2 current encoder (4 bytes)
 
+// Snapshot block: MODE1 through ENCODER2 (0x44-0x57) in one read
+#define HT_MOTOR_STATE_START  HT_MOTOR1_MODE
+#define HT_MOTOR_STATE_LENGTH 20
+
+// Shadow register file: MODE1 through ENCODER2_TARGET (0x44-0x4F)
+#define HT_MOTOR_SHADOW_START HT_MOTOR1_MODE
+#define HT_MOTOR_SHADOW_SIZE  12
+
+// Clean bytes bridged between two dirty runs instead of starting a new
+// transaction (each transaction costs START, address, register and STOP,
+// and the next write to the controller waits out HT_I2C_WRITE_GAP_US).
+// 3 lets the low bytes of both encoder targets share one burst.
+#ifndef HT_MOTOR_SHADOW_MERGE_GAP
+#define HT_MOTOR_SHADOW_MERGE_GAP 3
+#endif
+
+// With no writes pending, flush() reads the controller this often so its
+// 2.5 second I2C timeout never floats the motors (milliseconds)
+#ifndef HT_MOTOR_KEEPALIVE_MS
+#define HT_MOTOR_KEEPALIVE_MS 1000
+#endif
+
+// update() write period while ramping (milliseconds). The ramp itself is
+// integrated over elapsed time, so this only sets how often it is written.
+#ifndef HT_MOTOR_RAMP_MS
+#define HT_MOTOR_RAMP_MS 20
+#endif
+
+// Fastest ramp rate (power units per second; 10000 = 0 to 100% in 10 ms)
+#define HT_SLEW_MAX_RATE 10000
+
+// Elapsed time integrated per multiply, and the most one ramp step credits
+// (a stalled loop does not turn into one huge jump past this)
+#define HT_SLEW_CHUNK_US 20000UL
+#define HT_SLEW_MAX_ELAPSED_US 1000000UL
+
+// Ramp profiles (setRampProfile)
+#define HT_PROFILE_LINEAR      0  // Constant rate (default)
+#define HT_PROFILE_FREEWHEEL   1  // Coast, controlled ramp, coast below threshold
+#define HT_PROFILE_EXPONENTIAL 2  // Fast start, slow approach to the target
+#define HT_PROFILE_SCURVE      3  // Slow start and finish, fastest mid-ramp
+
+// Shaped profiles are precomputed into this many evenly spaced steps
+#define HT_PROFILE_STEPS 16
+
+// Freewheel profile: a drop of more than HT_FREEWHEEL_DROP from above
+// HT_FREEWHEEL_ABOVE coasts for HT_FREEWHEEL_MS before the controlled
+// ramp; ramping to zero coasts once power falls below HT_FREEWHEEL_THRESHOLD
+#ifndef HT_FREEWHEEL_MS
+#define HT_FREEWHEEL_MS 1000
+#endif
+#define HT_FREEWHEEL_ABOVE 30
+#define HT_FREEWHEEL_DROP 20
+#define HT_FREEWHEEL_THRESHOLD 25
+
+// Power register value (speed cap) written with position mode by moveTo()
+#ifndef HT_TRAJECTORY_POWER
+#define HT_TRAJECTORY_POWER 100
+#endif
+
+// Velocity estimator gains (alpha-beta filter, 1/256ths). The defaults
+// are critically damped: beta = alpha^2 / (2 - alpha).
+#ifndef HT_VELOCITY_ALPHA
+#define HT_VELOCITY_ALPHA 128
+#endif
+#ifndef HT_VELOCITY_BETA
+#define HT_VELOCITY_BETA 43
+#endif
+
+// Samples further apart than this restart the estimate from the two-point
+// slope (microseconds)
+#define HT_VELOCITY_MAX_DT_US 250000UL
+
+// Speed loop error clamp (counts/s). Keeps every gain product within 32
+// bits; TETRIX motors top out near 2500 counts/s.
+#define HT_SPEED_MAX_ERROR 4096
+
+// Consecutive in-tolerance samples before onMotionComplete() fires
+#ifndef HT_MOTION_SAMPLES
+#define HT_MOTION_SAMPLES 3
+#endif
+
 // Motor selection
 #define MOTOR_1 1
 #define MOTOR_2 2
@@ -45,11 +129,91 @@
 #define MOTOR_FORWARD  1
 #define MOTOR_REVERSE -1
 #define MOTOR_BRAKE    0
+#define MOTOR_FLOAT    -128  // Freewheel/coast mode
+
+// Controller registers captured by a single readState() transaction
+struct HiTechnicMotorState {
+  uint8_t mode1;      // 0x44
+  int8_t  power1;     // 0x45
+  int8_t  power2;     // 0x46
+  uint8_t mode2;      // 0x47
+  int32_t target1;    // 0x48-0x4B
+  int32_t target2;    // 0x4C-0x4F
+  int32_t encoder1;   // 0x50-0x53
+  int32_t encoder2;   // 0x54-0x57
+};
+
+// Per-motor slew limiter: power in Q8.8, rates as Q8.8 LSBs per
+// microsecond scaled by 2^16, with the sub-LSB remainder carried between
+// steps so the ramp length does not depend on the step rate
+struct HiTechnicSlew {
+  int16_t power;        // Current power, Q8.8
+  uint16_t fraction;    // Remainder below one Q8.8 LSB (1/65536ths)
+  uint32_t accelStep;   // Away from zero
+  uint32_t decelStep;   // Toward zero
+  uint16_t accelRate;   // Power units per second
+  uint16_t decelRate;
+};
+
+// Shaped ramp precomputed by setMotorPowerSmooth(): the power to write at
+// HT_PROFILE_STEPS + 1 evenly spaced times, interpolated in between.
+// MOTOR_FLOAT entries are written as-is.
+struct HiTechnicProfile {
+  uint8_t type;                          // HT_PROFILE_*
+  bool active;                           // Table ramp in progress
+  int8_t table[HT_PROFILE_STEPS + 1];
+  unsigned long start;                   // micros() of table[0] (after any coast)
+  uint32_t duration;                     // Microseconds from table[0] to the end
+};
+
+// Per-motor encoder velocity estimate: an alpha-beta filter in fixed
+// point. The position estimate is kept as an offset from the last sample
+// so it never overflows; velocity is counts per microsecond in Q20.
+struct HiTechnicVelocity {
+  int32_t count;          // Last encoder sample
+  unsigned long time;     // micros() at the middle of its transaction
+  int32_t offset;         // Position estimate minus count, Q8
+  int32_t velocity;       // Counts per microsecond, Q20
+  bool primed;            // A sample has been taken since the last reset
+};
+
+// Host-side speed PID for one motor. Gains are Q16 power units:
+// kp per count/s of error, ki per count of accumulated error, kd per
+// count/s^2 (on the measured velocity), kf per count/s of target.
+// ki and kd are folded with the loop period into per-step factors.
+struct HiTechnicSpeedLoop {
+  bool enabled;
+  int16_t target;         // Counts per second
+  uint16_t kp;
+  uint16_t ki;
+  uint16_t kd;
+  uint16_t kf;
+  uint32_t period;        // Step period the factors below were made for (us)
+  int32_t kiStep;         // ki * period, Q24
+  int32_t kdStep;         // kd / period, Q16
+  int32_t iLimit;         // Largest error kiStep can multiply
+  int32_t dLimit;         // Largest velocity change kdStep can multiply
+  int32_t integral;       // Integral term, Q16 power
+  int16_t lastVelocity;
+};
+
+// Motion-complete callback: context is passed through unchanged
+typedef void (*HiTechnicMotionCallback)(void* context, uint8_t motor);
+
+// Per-motor watch behind onMotionComplete()
+struct HiTechnicMotionWatch {
+  HiTechnicMotionCallback callback;
+  void* context;
+  int32_t target;         // Target the samples are counted against
+  uint8_t count;          // Consecutive samples within tolerance
+  bool armed;             // Not yet fired for this target
+};
 
 class HiTechnicMotor {
   public:
-    // Constructor - specify I2C address (default 0x02)
-    HiTechnicMotor(uint8_t address = 0x02);
+    // Constructor - specify I2C address (default 0x02) and optionally the
+    // bus the controller is on (default: hardware Wire)
+    HiTechnicMotor(uint8_t address = 0x02, HiTechnicBus& bus = HTWireBus);
     
     // Initialize the motor controller
     void begin();
@@ -59,21 +223,47 @@ class HiTechnicMotor {
     
     // Set motor power with acceleration control (smooth ramping)
     // power: target power (-100 to 100)
-    // acceleration: power change per update (1-100, higher = faster ramp)
-    void setMotorPowerSmooth(uint8_t motor, int8_t power, uint8_t acceleration = 10);
+    // acceleration: power change per 20 ms when speeding up (1-100,
+    // higher = faster ramp); 0 keeps the current rates
+    // deceleration: the same when slowing down; 0 = same as acceleration
+    // The motor's ramp profile (setRampProfile) is applied here.
+    void setMotorPowerSmooth(uint8_t motor, int8_t power, uint8_t acceleration = 0, uint8_t deceleration = 0);
     
-    // Update motor power ramping (call this in loop() for smooth acceleration)
-    // Returns true if any motor is still ramping
+    // Update motor power ramping and moveTo() trajectories (call this in
+    // loop()). Returns true if any motor is still ramping or moving
     bool update();
     
+    // Advance ramping by one step right away, without update()'s 20 ms
+    // gate and without writing (used by HiTechnicChain's tick)
+    // Returns true if any motor is still ramping
+    bool stepRamp();
+    
     // Set acceleration rate for all future smooth power changes
-    // acceleration: power change per update cycle (1-100, default 10)
+    // acceleration: power change per 20 ms (1-100, default 10), i.e.
+    // setRampRate(MOTOR_BOTH, acceleration * 50, acceleration * 50)
     void setAcceleration(uint8_t acceleration);
     
+    // Set deceleration rate for all future smooth power changes
+    // deceleration: power change per 20 ms when slowing down (1-100)
+    void setDeceleration(uint8_t deceleration);
+    
+    // Set ramp limits in power units per second (1 to HT_SLEW_MAX_RATE):
+    // accelRate while power moves away from zero, decelRate toward it.
+    // Ramps are integrated over elapsed micros(), so they take the same
+    // time whatever rate update() is called at.
+    void setRampRate(uint8_t motor, uint16_t accelRate, uint16_t decelRate);
+    
+    // Select the ramp shape for future setMotorPowerSmooth() calls
+    // (HT_PROFILE_LINEAR, _FREEWHEEL, _EXPONENTIAL or _SCURVE). Shaped
+    // profiles take as long as the linear ramp at the configured rates.
+    void setRampProfile(uint8_t motor, uint8_t profile);
+    uint8_t getRampProfile(uint8_t motor);
+    
     // Get current target power (what the motor is ramping toward)
     int8_t getTargetPower(uint8_t motor);
     
-    // Get current actual power being sent to motor
+    // Get current actual power being sent to motor (0 in position mode,
+    // where the power register only caps the speed)
     int8_t getCurrentPower(uint8_t motor);
     
     // Set motor mode (MOTOR_MODE_POWER, MOTOR_MODE_SPEED, or MOTOR_MODE_POSITION)
@@ -94,15 +284,136 @@ class HiTechnicMotor {
     // Read current encoder value
     int32_t readEncoder(uint8_t motor);
     
+    // Read modes, powers, targets and encoders in one transaction
+    // Returns true if the full block was received
+    bool readState();
+    
+    // Get the snapshot captured by the last readState()
+    const HiTechnicMotorState& getState();
+    
+    // Get encoder value from the last readState() (no I2C traffic)
+    int32_t getEncoder(uint8_t motor);
+    
+    // micros() at the middle of the transaction that read getEncoder()'s
+    // value (async reads: at completion)
+    unsigned long getEncoderTime(uint8_t motor);
+    
+    // Encoder velocity in counts per second, filtered over the timestamped
+    // samples taken by readEncoder(), readState() and their async variants
+    int32_t getVelocity(uint8_t motor);
+    
+    // Non-blocking variants built on HTAsyncI2C (see HiTechnicAsyncI2C.h).
+    // Each returns false if a read is already in flight, the controller
+    // is not isReady(), the queue is full, or the controller is not on
+    // the default Wire bus; status (optional) reads HT_ASYNC_PENDING until
+    // HTAsyncI2C.poll() delivers the result.
+    // Queue a snapshot read; getState()/getEncoder() update on completion
+    bool readStateAsync(volatile uint8_t* status = NULL);
+    
+    // Queue a single encoder read; getEncoder() updates on completion
+    bool readEncoderAsync(uint8_t motor, volatile uint8_t* status = NULL);
+    
+    // Check if an async read is still in flight
+    bool isAsyncBusy();
+    
     // Set target encoder position (for position mode)
     void setTargetPosition(uint8_t motor, int32_t target);
     
+    // Hold a speed in counts per second with the host-side PID, which
+    // reads a snapshot and writes both powers once per step (update()'s
+    // 20 ms grid, or HiTechnicChain::setControlRate()). The motor runs in
+    // power mode; setMotorPower() or moveTo() hands control back.
+    void setTargetVelocity(uint8_t motor, int16_t velocity);
+    
+    // Speed PID gains in 1/65536 power units (see HiTechnicSpeedLoop):
+    // e.g. kf = 65536 * 100 / top speed, kp about kf, ki a few times kp
+    void setSpeedGains(uint8_t motor, uint16_t kp, uint16_t ki, uint16_t kd, uint16_t kf);
+    
+    // Check if the speed PID is driving the motor (MOTOR_BOTH: either)
+    bool isSpeedControlled(uint8_t motor);
+    
+    // Run one speed PID step now for a loop period in microseconds
+    // (1000 or more):
+    // snapshot read, then the new powers are staged (not written)
+    // Returns false if no motor is speed controlled or the read failed
+    bool stepSpeed(uint32_t period);
+    
+    // Velocity, acceleration and jerk limits for moveTo() (counts/s,
+    // counts/s^2, counts/s^3)
+    void setTrajectoryLimits(uint8_t motor, uint32_t velocity, uint32_t acceleration, uint32_t jerk);
+    
+    // Move to goal along a jerk-limited trajectory in position mode.
+    // update() (or HiTechnicChain) streams the intermediate targets on the
+    // ramp grid; when both motors move, both targets share one burst.
+    // A new goal during a move replans from the current target.
+    // Returns false (and starts nothing) if the encoder read for the start
+    // point fails.
+    bool moveTo(uint8_t motor, int32_t goal);
+    
+    // Set both motors' mode, power limit and targets in one 12-byte burst
+    // (0x44-0x4F), so both axes latch their setpoints together. Takes
+    // both motors over from ramps, speed loops and moveTo().
+    void setTargets(int32_t target1, int32_t target2, uint8_t mode = MOTOR_MODE_POSITION,
+                    int8_t power = HT_TRAJECTORY_POWER);
+    
+    // Stage a position-mode target from an external planner (e.g.
+    // HiTechnicMove). The first call switches the motor to position mode
+    // with the HT_TRAJECTORY_POWER cap; later calls only move the target.
+    void streamTarget(uint8_t motor, int32_t target);
+    
+    // Check if a moveTo() trajectory is still being streamed
+    // (MOTOR_BOTH: either motor)
+    bool isMoving(uint8_t motor);
+    
+    // Write registers that changed since the last flush, merged into the
+    // fewest bursts. Setters call this automatically; unchanged values
+    // produce no bus writes.
+    void flush();
+    
+    // Queue pending register changes on HTAsyncI2C instead of blocking
+    // Returns false if the controller is not isReady(), the queue filled
+    // up (the rest stays pending) or the controller is not on the default
+    // Wire bus
+    bool flushAsync();
+    
+    // Setters write immediately by default; with auto flush off they only
+    // stage values until flush() or flushAsync() is called
+    void setAutoFlush(bool enabled);
+    bool getAutoFlush();
+    
+    // Check if any register change is waiting to be written
+    bool hasPendingWrites();
+    
+    // Forget cached register values so the next flush rewrites them
+    // (use after writing to the controller outside this class)
+    void invalidateShadow();
+    
     // Read firmware version
     uint8_t readVersion();
     
-    // Check if motor is at target position
+    // Check if motor is at target position: one encoder read compared
+    // with the target this class wrote (false while a moveTo() is running)
     bool isAtTarget(uint8_t motor, int32_t tolerance = 10);
     
+    // Position target as last written (the goal while a moveTo() is
+    // running), without bus traffic; reads the controller only if this
+    // class has not written a target yet
+    int32_t getTargetPosition(uint8_t motor);
+    
+    // Call back once the motor has stayed within tolerance of its position
+    // target for HT_MOTION_SAMPLES consecutive samples (setMotionTolerance).
+    // Checked by update() or HiTechnicChain on each tick with one snapshot
+    // for both motors; fires once per target, and a new target re-arms it.
+    // NULL removes the callback.
+    void onMotionComplete(uint8_t motor, HiTechnicMotionCallback callback, void* context = NULL);
+    
+    // Tolerance (counts) and consecutive samples for onMotionComplete()
+    void setMotionTolerance(int32_t tolerance, uint8_t samples = HT_MOTION_SAMPLES);
+    
+    // Take a snapshot and advance the motion-complete watches now if any
+    // is waiting (used by HiTechnicChain's tick). Returns true if read.
+    bool checkMotion();
+    
     // Change I2C address (WARNING: Changes persist after power cycle!)
     // newAddress should be 0x02 to 0x10 (even numbers recommended)
     // Returns true if successful
@@ -111,22 +422,106 @@ class HiTechnicMotor {
     // Get current I2C address
     uint8_t getI2CAddress();
     
+    // Check if the controller can be accessed without waiting
+    // (false while an async write is queued, and for HT_I2C_WRITE_GAP_US
+    // after each write completes)
+    bool isReady();
+    
   private:
     uint8_t _address;
+    HiTechnicBus* _bus;
+    unsigned long _lastWriteTime; // micros() of the last completed write
+    unsigned long _lastAccessTime; // millis() of the last transaction
     
     // Acceleration control variables
     int8_t _motor1TargetPower;
     int8_t _motor2TargetPower;
     int8_t _motor1CurrentPower;
     int8_t _motor2CurrentPower;
-    uint8_t _acceleration;
+    HiTechnicSlew _slew1;
+    HiTechnicSlew _slew2;
+    HiTechnicProfile _profile1;
+    HiTechnicProfile _profile2;
     unsigned long _lastUpdateTime;
+    unsigned long _lastRampTime;  // micros() of the last ramp step
+    
+    // moveTo() trajectories
+    HiTechnicTrajectory _trajectory1;
+    HiTechnicTrajectory _trajectory2;
+    bool _moving1;
+    bool _moving2;
+    unsigned long _moveStart1;    // micros() the trajectory started
+    unsigned long _moveStart2;
+    
+    // Last snapshot read from the controller
+    HiTechnicMotorState _state;
+    
+    // Speed PID state
+    HiTechnicSpeedLoop _speed1;
+    HiTechnicSpeedLoop _speed2;
+    
+    // Motion-complete watches
+    HiTechnicMotionWatch _watch1;
+    HiTechnicMotionWatch _watch2;
+    int32_t _motionTolerance;
+    uint8_t _motionSamples;
+    
+    // Timestamped encoder samples and velocity estimates
+    HiTechnicVelocity _velocity1;
+    HiTechnicVelocity _velocity2;
+    
+    // Destination for async reads
+    uint8_t _asyncBlock[HT_MOTOR_STATE_LENGTH];
+    volatile bool _asyncReadBusy;
+    uint8_t _asyncWrites;   // Queued async writes not yet completed
+    
+    // Shadow of the writable registers 0x44-0x4F
+    uint8_t _shadow[HT_MOTOR_SHADOW_SIZE];
+    uint16_t _shadowValid;  // Bytes known to match the controller
+    uint16_t _shadowDirty;  // Bytes changed since the last flush
+    bool _autoFlush;        // Setters flush immediately
     
     // I2C communication helpers
+    void waitForDevice();
     void writeRegister(uint8_t reg, uint8_t value);
-    void writeRegister32(uint8_t reg, int32_t value);
+    void writeRegisters(uint8_t reg, const uint8_t* data, uint8_t length);
     uint8_t readRegister(uint8_t reg);
-    int32_t readRegister32(uint8_t reg);
+    uint8_t readRegisters(uint8_t reg, uint8_t* data, uint8_t length);
+    bool sampleEncoder(uint8_t motor);
+    static int32_t decode32(const uint8_t* data);
+    
+    // Shadow register helpers
+    void setShadow(uint8_t reg, uint8_t value);
+    void setShadow32(uint8_t reg, int32_t value);
+    uint16_t shadowBit(uint8_t reg);
+    bool writeShadowRange(uint8_t index, uint8_t length, bool async);
+    bool flushShadow(bool async);
+    bool usesAsyncBus();
+    
+    // Ramp helpers
+    static uint32_t slewRate(uint16_t unitsPerSecond);
+    static bool slewStep(HiTechnicSlew& slew, int8_t target, uint32_t elapsed);
+    static int8_t slewPower(const HiTechnicSlew& slew);
+    static void buildProfile(HiTechnicProfile& profile, const HiTechnicSlew& slew,
+                             int8_t current, int8_t target);
+    static bool rampMotor(HiTechnicSlew& slew, HiTechnicProfile& profile, int8_t target,
+                          int8_t& current, uint32_t elapsed, unsigned long now, int8_t& output);
+    
+    static int8_t speedStep(HiTechnicSpeedLoop& loop, int32_t velocity, uint32_t period);
+    void stageTarget(uint8_t motor, int32_t target, uint8_t mode, int8_t power);
+    bool cachedTarget(uint8_t motor, int32_t& target);
+    bool watchPending(HiTechnicMotionWatch& watch, uint8_t motor);
+    void advanceWatch(HiTechnicMotionWatch& watch, uint8_t motor, int32_t encoder);
+    bool stepTrajectory(HiTechnicTrajectory& trajectory, bool& moving,
+                        unsigned long start, unsigned long now, uint8_t reg);
+    
+    // Snapshot helpers
+    void decodeState(const uint8_t* block, unsigned long time);
+    static void sampleVelocity(HiTechnicVelocity& filter, int32_t count, unsigned long time);
+    static void onStateRead(void* context, uint8_t status);
+    static void onEncoder1Read(void* context, uint8_t status);
+    static void onEncoder2Read(void* context, uint8_t status);
+    static void onWrite(void* context, uint8_t status);
 };
 
 #endif
@@ -0,0 +1,173 @@
+/*
+  HiTechnicMove.cpp - Coordinated point-to-point move across several motors
+*/
+
+#include "HiTechnicMove.h"
+
+// Constructor
+HiTechnicMove::HiTechnicMove() {
+  _axisCount = 0;
+  _startTime = 0;
+  _moving = false;
+}
+
+bool HiTechnicMove::addAxis(HiTechnicMotor& controller, uint8_t motor) {
+  if (_axisCount >= HT_MOVE_MAX_AXES || (motor != MOTOR_1 && motor != MOTOR_2)) {
+    return false;
+  }
+  
+  uint8_t axis = _axisCount++;
+  _controllers[axis] = &controller;
+  _motors[axis] = motor;
+  _velocity[axis] = HT_TRAJECTORY_VELOCITY;
+  _acceleration[axis] = HT_TRAJECTORY_ACCELERATION;
+  _jerk[axis] = HT_TRAJECTORY_JERK;
+  _start[axis] = 0;
+  _goal[axis] = 0;
+  _last[axis] = 0;
+  _ratio[axis] = 0;
+  return true;
+}
+
+void HiTechnicMove::setLimits(uint8_t axis, uint32_t velocity, uint32_t acceleration, uint32_t jerk) {
+  if (axis >= _axisCount) {
+    return;
+  }
+  _velocity[axis] = (velocity > 0) ? velocity : 1;
+  _acceleration[axis] = (acceleration > 0) ? acceleration : 1;
+  _jerk[axis] = (jerk > 0) ? jerk : 1;
+}
+
+bool HiTechnicMove::moveTo(const int32_t goals[]) {
+  // Start points: the targets being streamed, or one snapshot per
+  // controller (both of its encoders in one read)
+  if (!_moving) {
+    for (uint8_t i = 0; i < _axisCount; i++) {
+      if (!sharesController(i) && !_controllers[i]->readState()) {
+        return false;  // Unknown start point: leave every axis as it is
+      }
+    }
+  }
+  for (uint8_t i = 0; i < _axisCount; i++) {
+    _start[i] = _moving ? _last[i] : _controllers[i]->getEncoder(_motors[i]);
+  }
+  
+  // The longest axis sets the path length
+  uint32_t longest = 0;
+  for (uint8_t i = 0; i < _axisCount; i++) {
+    _goal[i] = goals[i];
+    uint32_t distance = (goals[i] >= _start[i]) ? (uint32_t)(goals[i] - _start[i])
+                                                : (uint32_t)(_start[i] - goals[i]);
+    if (distance > longest) {
+      longest = distance;
+    }
+  }
+  
+  // Each axis moves ratio counts per path count, so the path may go no
+  // faster than limit / ratio for any axis
+  float velocity = 4.0e9;
+  float acceleration = 4.0e9;
+  float jerk = 4.0e9;
+  for (uint8_t i = 0; i < _axisCount; i++) {
+    _ratio[i] = (longest > 0) ? (float)(_goal[i] - _start[i]) / longest : 0;
+    float share = (_ratio[i] >= 0) ? _ratio[i] : -_ratio[i];
+    if (share <= 0) {
+      continue;
+    }
+    if (_velocity[i] / share < velocity) {
+      velocity = _velocity[i] / share;
+    }
+    if (_acceleration[i] / share < acceleration) {
+      acceleration = _acceleration[i] / share;
+    }
+    if (_jerk[i] / share < jerk) {
+      jerk = _jerk[i] / share;
+    }
+  }
+  
+  _path.setLimits((uint32_t)velocity, (uint32_t)acceleration, (uint32_t)jerk);
+  _path.plan(0, longest);
+  _startTime = micros();
+  _moving = true;
+  stageAll(0);
+  return true;
+}
+
+bool HiTechnicMove::step() {
+  if (!_moving) {
+    return false;
+  }
+  
+  uint32_t elapsed = micros() - _startTime;
+  if (elapsed >= _path.getDuration()) {
+    // Land exactly on the goals
+    for (uint8_t i = 0; i < _axisCount; i++) {
+      _last[i] = _goal[i];
+    }
+    streamAll();
+    _moving = false;
+    return false;
+  }
+  
+  stageAll(elapsed);
+  return true;
+}
+
+// Scale the path position onto every axis and stream the targets
+void HiTechnicMove::stageAll(uint32_t elapsed) {
+  float s = _path.position(elapsed);
+  for (uint8_t i = 0; i < _axisCount; i++) {
+    float offset = s * _ratio[i];
+    _last[i] = _start[i] + (int32_t)(offset + (offset >= 0 ? 0.5 : -0.5));
+  }
+  streamAll();
+}
+
+// Stream _last[] to every axis. Each controller's auto flush is held off
+// until all of its axes are staged, so it writes both targets in one
+// burst (in a HiTechnicChain auto flush is already off and the chain
+// writes them).
+void HiTechnicMove::streamAll() {
+  bool autoFlush[HT_MOVE_MAX_AXES];
+  for (uint8_t i = 0; i < _axisCount; i++) {
+    if (!sharesController(i)) {
+      autoFlush[i] = _controllers[i]->getAutoFlush();
+      _controllers[i]->setAutoFlush(false);
+    }
+  }
+  
+  for (uint8_t i = 0; i < _axisCount; i++) {
+    _controllers[i]->streamTarget(_motors[i], _last[i]);
+  }
+  
+  for (uint8_t i = 0; i < _axisCount; i++) {
+    if (!sharesController(i)) {
+      _controllers[i]->setAutoFlush(autoFlush[i]);
+      if (autoFlush[i]) {
+        _controllers[i]->flush();
+      }
+    }
+  }
+}
+
+// Check if an earlier axis is on the same controller
+bool HiTechnicMove::sharesController(uint8_t axis) {
+  for (uint8_t k = 0; k < axis; k++) {
+    if (_controllers[k] == _controllers[axis]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HiTechnicMove::isMoving() {
+  return _moving;
+}
+
+uint32_t HiTechnicMove::getDuration() {
+  return _path.getDuration();
+}
+
+uint8_t HiTechnicMove::getAxisCount() {
+  return _axisCount;
+}
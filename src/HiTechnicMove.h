@@ -0,0 +1,98 @@
+/*
+  HiTechnicMove.h - Coordinated point-to-point move across several motors
+
+  All axes of a move follow one jerk-limited path: the longest axis runs
+  the S-curve, and every other axis covers the same fraction of its own
+  distance at the same time, so all of them start and finish together and
+  the motion is a straight line in joint space. The shared path is
+  planned with the tightest limits any axis imposes once scaled by its
+  share of the distance, so no axis exceeds its own velocity,
+  acceleration or jerk limits.
+
+  Each step evaluates the path once and scales it per axis (one float
+  multiply each), then stages the targets and writes each controller
+  once, so a controller's two targets go out in one burst. Added to a
+  HiTechnicChain the step runs on the chain's tick and the chain does the
+  writing.
+
+  Usage:
+    HiTechnicMove gantry;
+    gantry.addAxis(controller1, MOTOR_1);   // X
+    gantry.addAxis(controller1, MOTOR_2);   // Y
+    gantry.addAxis(controller2, MOTOR_1);   // Z
+    chain.addMove(gantry);
+
+    const int32_t goals[] = {4000, 1500, -800};
+    gantry.moveTo(goals);
+    while (chain.update()) { }
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicMove_h
+#define HiTechnicMove_h
+
+#include "Arduino.h"
+#include "HiTechnicMotor.h"
+#include "HiTechnicTrajectory.h"
+
+// Axes one move can coordinate
+#ifndef HT_MOVE_MAX_AXES
+#define HT_MOVE_MAX_AXES 8
+#endif
+
+class HiTechnicMove {
+  public:
+    HiTechnicMove();
+    
+    // Add a motor as the next axis; returns false if the move is full
+    bool addAxis(HiTechnicMotor& controller, uint8_t motor);
+    
+    // Velocity, acceleration and jerk limits of one axis (counts/s,
+    // counts/s^2, counts/s^3; defaults HT_TRAJECTORY_*)
+    void setLimits(uint8_t axis, uint32_t velocity, uint32_t acceleration, uint32_t jerk);
+    
+    // Start a move to goals[axis] from the current encoder positions
+    // (one snapshot read per controller). A move in progress restarts
+    // from its current targets. Returns false (and starts nothing) if a
+    // snapshot read fails.
+    bool moveTo(const int32_t goals[]);
+    
+    // Stage every axis's target for now and write each controller once
+    // (HiTechnicChain calls this on its tick). Returns true while the move
+    // is running.
+    bool step();
+    
+    // Check if the move is still running
+    bool isMoving();
+    
+    // Length of the current move in microseconds
+    uint32_t getDuration();
+    
+    uint8_t getAxisCount();
+    
+  private:
+    HiTechnicMotor* _controllers[HT_MOVE_MAX_AXES];
+    uint8_t _motors[HT_MOVE_MAX_AXES];
+    uint8_t _axisCount;
+    
+    // Per-axis limits and the current move
+    uint32_t _velocity[HT_MOVE_MAX_AXES];
+    uint32_t _acceleration[HT_MOVE_MAX_AXES];
+    uint32_t _jerk[HT_MOVE_MAX_AXES];
+    int32_t _start[HT_MOVE_MAX_AXES];
+    int32_t _goal[HT_MOVE_MAX_AXES];
+    int32_t _last[HT_MOVE_MAX_AXES];   // Last staged target
+    float _ratio[HT_MOVE_MAX_AXES];    // Axis distance / path distance
+    
+    // Shared path from 0 to the longest axis distance
+    HiTechnicTrajectory _path;
+    unsigned long _startTime;
+    bool _moving;
+    
+    void stageAll(uint32_t elapsed);
+    void streamAll();
+    bool sharesController(uint8_t axis);
+};
+
+#endif
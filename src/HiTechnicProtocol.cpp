@@ -0,0 +1,229 @@
+/*
+  HiTechnicProtocol.cpp - Binary framed command/telemetry link
+*/
+
+#include "HiTechnicProtocol.h"
+
+// Receive states
+#define HT_RX_SYNC     0
+#define HT_RX_VERSION  1
+#define HT_RX_LENGTH   2
+#define HT_RX_SEQUENCE 3
+#define HT_RX_ID       4
+#define HT_RX_PAYLOAD  5
+#define HT_RX_CRC_LOW  6
+#define HT_RX_CRC_HIGH 7
+
+// Constructor
+HiTechnicProtocol::HiTechnicProtocol(Print& out) {
+  _out = &out;
+  _txSequence = 0;
+  _frames = 0;
+  _crcErrors = 0;
+  _frameErrors = 0;
+  reset();
+}
+
+void HiTechnicProtocol::reset() {
+  _state = HT_RX_SYNC;
+  _valid = false;
+}
+
+// Advance the receive state machine by one byte. The payload goes
+// straight into its final place in _buffer.
+bool HiTechnicProtocol::parse(uint8_t data) {
+  _valid = false;
+  
+  switch (_state) {
+    case HT_RX_SYNC:
+      if (data == HT_PROTOCOL_SYNC) {
+        _crc = 0xFFFF;
+        _state = HT_RX_VERSION;
+      }
+      return false;
+      
+    case HT_RX_VERSION:
+      _version = data;
+      _crc = crc16(_crc, data);
+      _state = HT_RX_LENGTH;
+      return false;
+      
+    case HT_RX_LENGTH:
+      if (data > HT_PROTOCOL_MAX_PAYLOAD) {
+        _frameErrors++;
+        _state = HT_RX_SYNC;
+        return false;
+      }
+      _length = data;
+      _crc = crc16(_crc, data);
+      _state = HT_RX_SEQUENCE;
+      return false;
+      
+    case HT_RX_SEQUENCE:
+      _sequence = data;
+      _crc = crc16(_crc, data);
+      _state = HT_RX_ID;
+      return false;
+      
+    case HT_RX_ID:
+      _id = data;
+      _crc = crc16(_crc, data);
+      _index = 0;
+      _state = (_length > 0) ? HT_RX_PAYLOAD : HT_RX_CRC_LOW;
+      return false;
+      
+    case HT_RX_PAYLOAD:
+      _buffer[_index++] = data;
+      _crc = crc16(_crc, data);
+      if (_index >= _length) {
+        _state = HT_RX_CRC_LOW;
+      }
+      return false;
+      
+    case HT_RX_CRC_LOW:
+      _crcLow = data;
+      _state = HT_RX_CRC_HIGH;
+      return false;
+      
+    case HT_RX_CRC_HIGH:
+      _state = HT_RX_SYNC;
+      if ((((uint16_t)data << 8) | _crcLow) != _crc) {
+        _crcErrors++;
+        return false;
+      }
+      if (_version != HT_PROTOCOL_VERSION) {
+        _frameErrors++;
+        return false;
+      }
+      _frames++;
+      _valid = true;
+      return true;
+  }
+  
+  _state = HT_RX_SYNC;
+  return false;
+}
+
+uint8_t HiTechnicProtocol::getMessageId() {
+  return _id;
+}
+
+uint8_t HiTechnicProtocol::getSequence() {
+  return _sequence;
+}
+
+uint8_t HiTechnicProtocol::getLength() {
+  return _length;
+}
+
+const uint8_t* HiTechnicProtocol::getPayload() {
+  return _buffer;
+}
+
+bool HiTechnicProtocol::readCommand(HiTechnicMotorCommand& command) {
+  if (!_valid || _id != HT_MSG_MOTOR_COMMAND || _length < HT_MOTOR_COMMAND_LENGTH) {
+    return false;
+  }
+  
+  command.motorMask = _buffer[0];
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    command.powers[i] = (int8_t)_buffer[1 + i];
+  }
+  return true;
+}
+
+bool HiTechnicProtocol::readTelemetry(HiTechnicMotorTelemetry& telemetry) {
+  if (!_valid || (_id != HT_MSG_MOTOR_TELEMETRY && _id != HT_MSG_TELEMETRY_KEYFRAME) ||
+      _length < HT_MOTOR_TELEMETRY_LENGTH) {
+    return false;
+  }
+  
+  const uint8_t* p = _buffer;
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    telemetry.powers[i] = (int8_t)*p++;
+  }
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    telemetry.encoders[i] = readInt32(p);
+    p += 4;
+  }
+  telemetry.status = p[0];
+  telemetry.batteryVoltage = p[1] | ((uint16_t)p[2] << 8);
+  return true;
+}
+
+uint8_t HiTechnicProtocol::getNextSequence() {
+  return _txSequence;
+}
+
+// Header, payload and CRC go out as they are produced, without a frame
+// buffer
+size_t HiTechnicProtocol::sendFrame(uint8_t id, const uint8_t* payload, uint8_t length) {
+  uint8_t header[5] = {HT_PROTOCOL_SYNC, HT_PROTOCOL_VERSION, length, _txSequence++, id};
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 1; i < 5; i++) {
+    crc = crc16(crc, header[i]);
+  }
+  for (uint8_t i = 0; i < length; i++) {
+    crc = crc16(crc, payload[i]);
+  }
+  
+  size_t written = _out->write(header, 5);
+  written += _out->write(payload, length);
+  written += _out->write((uint8_t)(crc & 0xFF));
+  written += _out->write((uint8_t)(crc >> 8));
+  return written;
+}
+
+size_t HiTechnicProtocol::sendTelemetry(const HiTechnicMotorTelemetry& telemetry, uint8_t id) {
+  uint8_t payload[HT_MOTOR_TELEMETRY_LENGTH];
+  uint8_t* p = payload;
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    *p++ = (uint8_t)telemetry.powers[i];
+  }
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    writeInt32(p, telemetry.encoders[i]);
+    p += 4;
+  }
+  p[0] = telemetry.status;
+  p[1] = telemetry.batteryVoltage & 0xFF;
+  p[2] = telemetry.batteryVoltage >> 8;
+  return sendFrame(id, payload, HT_MOTOR_TELEMETRY_LENGTH);
+}
+
+size_t HiTechnicProtocol::sendAck(uint8_t status) {
+  uint8_t payload[3] = {_id, _sequence, status};
+  return sendFrame(HT_MSG_ACK, payload, 3);
+}
+
+uint32_t HiTechnicProtocol::getFrameCount() {
+  return _frames;
+}
+
+uint32_t HiTechnicProtocol::getCrcErrors() {
+  return _crcErrors;
+}
+
+uint32_t HiTechnicProtocol::getFrameErrors() {
+  return _frameErrors;
+}
+
+// CRC-16/MCRF4XX, byte at a time without a table
+uint16_t HiTechnicProtocol::crc16(uint16_t crc, uint8_t data) {
+  uint8_t tmp = data ^ (uint8_t)(crc & 0xFF);
+  tmp ^= (tmp << 4);
+  return (crc >> 8) ^ ((uint16_t)tmp << 8) ^ ((uint16_t)tmp << 3) ^ (tmp >> 4);
+}
+
+int32_t HiTechnicProtocol::readInt32(const uint8_t* data) {
+  return (int32_t)((uint32_t)data[0] |
+                   ((uint32_t)data[1] << 8) |
+                   ((uint32_t)data[2] << 16) |
+                   ((uint32_t)data[3] << 24));
+}
+
+void HiTechnicProtocol::writeInt32(uint8_t* data, int32_t value) {
+  data[0] = value & 0xFF;
+  data[1] = (value >> 8) & 0xFF;
+  data[2] = (value >> 16) & 0xFF;
+  data[3] = (value >> 24) & 0xFF;
+}
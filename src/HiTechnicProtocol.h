@@ -0,0 +1,161 @@
+/*
+  HiTechnicProtocol.h - Binary framed command/telemetry link for driving
+  the motors from a companion computer or flight controller
+
+  Frame layout (multi-byte fields little-endian):
+
+    0xAA  version  length  sequence  id  payload[length]  crc16 (lo, hi)
+
+  The CRC is CRC-16/MCRF4XX (the X.25 variant MAVLink uses, polynomial
+  0x1021 reflected, initial value 0xFFFF) over version through the end of
+  the payload. Message IDs below 0x80 travel to the Arduino, 0x80 and
+  above come from it (HT_MSG_ACK also travels back to acknowledge
+  telemetry keyframes, see HiTechnicTelemetryStream.h). A receiver drops
+  frames whose version differs from HT_PROTOCOL_VERSION, so payload
+  layouts can change with the version.
+
+  The parser takes one byte at a time straight from the serial RX path
+  and assembles the payload in place: when parse() returns true the frame
+  is read through getPayload() and the decode helpers without copying,
+  and stays valid until the next parse() call. The send functions write
+  header, payload and CRC straight to the output stream.
+
+  A six-motor telemetry frame is 40 bytes, against roughly 100 for the
+  text format in PixhawkMotorControl.
+
+  Usage:
+    HiTechnicProtocol link(Serial1);
+
+    while (Serial1.available()) {
+      if (link.parse(Serial1.read())) {
+        HiTechnicMotorCommand command;
+        if (link.readCommand(command)) { ... }
+      }
+    }
+    link.sendTelemetry(telemetry);
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicProtocol_h
+#define HiTechnicProtocol_h
+
+#include "Arduino.h"
+
+#define HT_PROTOCOL_SYNC    0xAA
+#define HT_PROTOCOL_VERSION 1
+
+// Largest payload the parser accepts
+#ifndef HT_PROTOCOL_MAX_PAYLOAD
+#define HT_PROTOCOL_MAX_PAYLOAD 64
+#endif
+
+// Header (sync, version, length, sequence, id) and CRC bytes per frame
+#define HT_PROTOCOL_OVERHEAD 7
+
+// Motors carried by command and telemetry messages
+#define HT_PROTOCOL_MOTORS 6
+
+// Messages to the Arduino
+#define HT_MSG_MOTOR_COMMAND     0x01  // mask, powers[6]
+#define HT_MSG_STOP              0x02  // (empty)
+#define HT_MSG_RESET_ENCODERS    0x03  // (empty)
+#define HT_MSG_TELEMETRY_REQUEST 0x04  // (empty)
+
+// Messages from the Arduino
+#define HT_MSG_ACK               0x80  // id, sequence, status
+#define HT_MSG_MOTOR_TELEMETRY   0x81  // powers[6], encoders[6], status, battery
+#define HT_MSG_TELEMETRY_DELTA   0x82  // See HiTechnicTelemetryStream.h
+#define HT_MSG_TELEMETRY_KEYFRAME 0x83 // Same payload as HT_MSG_MOTOR_TELEMETRY
+
+// HT_MSG_ACK status values
+#define HT_ACK_OK        0
+#define HT_ACK_REJECTED  1  // Understood but not applied (e.g. out of range)
+#define HT_ACK_UNKNOWN   2  // Message ID not handled
+
+// HT_MSG_MOTOR_COMMAND payload
+struct HiTechnicMotorCommand {
+  uint8_t motorMask;                     // Bit n = motor n + 1 is set
+  int8_t powers[HT_PROTOCOL_MOTORS];     // -100 to 100
+};
+
+// HT_MSG_MOTOR_TELEMETRY payload
+struct HiTechnicMotorTelemetry {
+  int8_t powers[HT_PROTOCOL_MOTORS];     // Current power levels
+  int32_t encoders[HT_PROTOCOL_MOTORS];  // Encoder positions
+  uint8_t status;                        // Error flags, busy bits
+  uint16_t batteryVoltage;               // Volts * 100
+};
+
+#define HT_MOTOR_COMMAND_LENGTH   (1 + HT_PROTOCOL_MOTORS)
+#define HT_MOTOR_TELEMETRY_LENGTH (HT_PROTOCOL_MOTORS * 5 + 3)
+
+class HiTechnicProtocol {
+  public:
+    // Frames are sent to out (usually the same Serial port that feeds
+    // parse())
+    HiTechnicProtocol(Print& out);
+    
+    // Feed one received byte. Returns true when it completed a valid
+    // frame; the frame can then be read until the next call.
+    bool parse(uint8_t data);
+    
+    // Drop any partly received frame
+    void reset();
+    
+    // Fields of the last completed frame
+    uint8_t getMessageId();
+    uint8_t getSequence();
+    uint8_t getLength();
+    const uint8_t* getPayload();
+    
+    // Decode the last frame; false if it is a different message or too
+    // short (readTelemetry() also takes HT_MSG_TELEMETRY_KEYFRAME)
+    bool readCommand(HiTechnicMotorCommand& command);
+    bool readTelemetry(HiTechnicMotorTelemetry& telemetry);
+    
+    // Sequence number the next sent frame will carry
+    uint8_t getNextSequence();
+    
+    // Send a frame with the next sequence number; returns bytes written
+    size_t sendFrame(uint8_t id, const uint8_t* payload, uint8_t length);
+    size_t sendTelemetry(const HiTechnicMotorTelemetry& telemetry, uint8_t id = HT_MSG_MOTOR_TELEMETRY);
+    
+    // Acknowledge the last received frame (its id and sequence)
+    size_t sendAck(uint8_t status = HT_ACK_OK);
+    
+    // Receive statistics
+    uint32_t getFrameCount();    // Valid frames
+    uint32_t getCrcErrors();     // Complete frames with a bad CRC
+    uint32_t getFrameErrors();   // Oversized or wrong-version frames
+    
+    // CRC-16/MCRF4XX step (crc starts at 0xFFFF)
+    static uint16_t crc16(uint16_t crc, uint8_t data);
+    
+    // Little-endian field access for payloads
+    static int32_t readInt32(const uint8_t* data);
+    static void writeInt32(uint8_t* data, int32_t value);
+    
+  private:
+    Print* _out;
+    
+    // Receive state
+    uint8_t _state;
+    uint8_t _buffer[HT_PROTOCOL_MAX_PAYLOAD];
+    uint8_t _version;
+    uint8_t _length;
+    uint8_t _sequence;
+    uint8_t _id;
+    uint8_t _index;
+    uint16_t _crc;
+    uint8_t _crcLow;
+    bool _valid;                 // Fields above hold a completed frame
+    
+    uint8_t _txSequence;
+    
+    uint32_t _frames;
+    uint32_t _crcErrors;
+    uint32_t _frameErrors;
+};
+
+#endif
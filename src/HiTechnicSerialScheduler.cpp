@@ -0,0 +1,222 @@
+/*
+  HiTechnicSerialScheduler.cpp - Non-blocking, prioritized serial output
+*/
+
+#include "HiTechnicSerialScheduler.h"
+
+// Constructor
+HiTechnicSerialScheduler::HiTechnicSerialScheduler(Print& out) {
+  _out = &out;
+  _priority = HT_TX_DEBUG;
+  setCapacity(HT_TX_BUFFER_SIZE / 4, HT_TX_BUFFER_SIZE / 2, HT_TX_BUFFER_SIZE / 4);
+  resetCounters();
+}
+
+bool HiTechnicSerialScheduler::setCapacity(uint16_t ack, uint16_t telemetry, uint16_t debug) {
+  if ((uint32_t)ack + telemetry + debug > HT_TX_BUFFER_SIZE) {
+    return false;
+  }
+
+  uint16_t sizes[HT_TX_PRIORITIES] = {ack, telemetry, debug};
+  uint16_t start = 0;
+  for (uint8_t i = 0; i < HT_TX_PRIORITIES; i++) {
+    _rings[i].start = start;
+    _rings[i].size = sizes[i];
+    _rings[i].head = 0;
+    _rings[i].count = 0;
+    _rings[i].committed = 0;
+    start += sizes[i];
+  }
+  _building = -1;
+  _active = -1;
+  return true;
+}
+
+void HiTechnicSerialScheduler::setPriority(uint8_t priority) {
+  if (priority < HT_TX_PRIORITIES) {
+    _priority = priority;
+  }
+}
+
+// Reserve the length byte; the payload follows it
+void HiTechnicSerialScheduler::beginFrame(uint8_t priority) {
+  if (_building >= 0) {
+    endFrame();
+  }
+  if (priority >= HT_TX_PRIORITIES) {
+    priority = HT_TX_DEBUG;
+  }
+
+  HiTechnicTxRing& ring = _rings[priority];
+  _building = priority;
+  _lineFrame = false;
+  _frameLength = 0;
+  _overflow = false;
+  if (ring.count >= ring.size && priority == HT_TX_TELEMETRY) {
+    coalesce(ring);
+  }
+  if (ring.count >= ring.size) {
+    _overflow = true;
+    return;
+  }
+  ring.count++;
+}
+
+size_t HiTechnicSerialScheduler::write(uint8_t data) {
+  if (_building < 0) {
+    beginFrame(_priority);
+    _lineFrame = true;
+  }
+
+  HiTechnicTxRing& ring = _rings[_building];
+  if (!_overflow && ring.count >= ring.size && _building == HT_TX_TELEMETRY) {
+    coalesce(ring);
+  }
+  if (_overflow || _frameLength >= HT_TX_MAX_FRAME || ring.count >= ring.size) {
+    _overflow = true;
+  } else {
+    _pool[position(ring, ring.count)] = data;
+    ring.count++;
+  }
+  _frameLength++;
+
+  if (_lineFrame && data == '\n') {
+    endFrame();
+  }
+  return 1;
+}
+
+// Commit the frame by writing its length byte, or roll it back
+bool HiTechnicSerialScheduler::endFrame() {
+  if (_building < 0) {
+    return false;
+  }
+  HiTechnicTxRing& ring = _rings[_building];
+  _building = -1;
+
+  if (_overflow || _frameLength == 0) {
+    if (_frameLength > 0) {
+      ring.droppedBytes += _frameLength;
+      ring.droppedFrames++;
+    }
+    ring.count = ring.committed;
+    return false;
+  }
+
+  _pool[position(ring, ring.committed)] = (uint8_t)_frameLength;
+  ring.committed = ring.count;
+  if (ring.count > ring.highWater) {
+    ring.highWater = ring.count;
+  }
+  update();
+  return true;
+}
+
+// Finish the frame on the wire, then take the next one from the highest
+// priority ring. Only whole contiguous runs that fit the port's buffer
+// are written, so this never blocks.
+void HiTechnicSerialScheduler::update() {
+  int space = _out->availableForWrite();
+  while (space > 0) {
+    if (_active < 0) {
+      for (uint8_t i = 0; i < HT_TX_PRIORITIES && _active < 0; i++) {
+        if (_rings[i].committed > 0) {
+          _active = i;
+        }
+      }
+      if (_active < 0) {
+        return;
+      }
+      HiTechnicTxRing& ring = _rings[_active];
+      _remaining = _pool[ring.start + ring.head];
+      ring.head = (ring.head + 1 == ring.size) ? 0 : ring.head + 1;
+      ring.count--;
+      ring.committed--;
+    }
+
+    HiTechnicTxRing& ring = _rings[_active];
+    uint16_t run = ring.size - ring.head;
+    if (run > _remaining) {
+      run = _remaining;
+    }
+    if (run > (uint16_t)space) {
+      run = space;
+    }
+    _out->write(_pool + ring.start + ring.head, run);
+    ring.head += run;
+    if (ring.head == ring.size) {
+      ring.head = 0;
+    }
+    ring.count -= run;
+    ring.committed -= run;
+    _remaining -= run;
+    space -= run;
+    if (_remaining == 0) {
+      _active = -1;
+    }
+  }
+}
+
+// Discard the telemetry frames that have not started to go out. The
+// frame being built is moved down over them.
+void HiTechnicSerialScheduler::coalesce(HiTechnicTxRing& ring) {
+  uint16_t keep = (_active == HT_TX_TELEMETRY) ? _remaining : 0;
+  if (ring.committed <= keep) {
+    return;
+  }
+
+  for (uint16_t offset = keep; offset < ring.committed; ) {
+    uint8_t length = _pool[position(ring, offset)];
+    ring.droppedBytes += length;
+    ring.droppedFrames++;
+    offset += 1 + length;
+  }
+
+  uint16_t building = ring.count - ring.committed;
+  for (uint16_t i = 0; i < building; i++) {
+    _pool[position(ring, keep + i)] = _pool[position(ring, ring.committed + i)];
+  }
+  ring.count = keep + building;
+  ring.committed = keep;
+}
+
+uint16_t HiTechnicSerialScheduler::getQueued() {
+  uint16_t queued = 0;
+  for (uint8_t i = 0; i < HT_TX_PRIORITIES; i++) {
+    queued += _rings[i].committed;
+  }
+  return queued;
+}
+
+uint16_t HiTechnicSerialScheduler::getQueued(uint8_t priority) {
+  return (priority < HT_TX_PRIORITIES) ? _rings[priority].committed : 0;
+}
+
+uint32_t HiTechnicSerialScheduler::getDroppedBytes(uint8_t priority) {
+  return (priority < HT_TX_PRIORITIES) ? _rings[priority].droppedBytes : 0;
+}
+
+uint32_t HiTechnicSerialScheduler::getDroppedFrames(uint8_t priority) {
+  return (priority < HT_TX_PRIORITIES) ? _rings[priority].droppedFrames : 0;
+}
+
+uint16_t HiTechnicSerialScheduler::getHighWaterMark(uint8_t priority) {
+  return (priority < HT_TX_PRIORITIES) ? _rings[priority].highWater : 0;
+}
+
+void HiTechnicSerialScheduler::resetCounters() {
+  for (uint8_t i = 0; i < HT_TX_PRIORITIES; i++) {
+    _rings[i].highWater = _rings[i].committed;
+    _rings[i].droppedBytes = 0;
+    _rings[i].droppedFrames = 0;
+  }
+}
+
+// Pool index of the byte offset bytes after the ring's head
+uint16_t HiTechnicSerialScheduler::position(HiTechnicTxRing& ring, uint16_t offset) {
+  uint16_t index = ring.head + offset;
+  if (index >= ring.size) {
+    index -= ring.size;
+  }
+  return ring.start + index;
+}
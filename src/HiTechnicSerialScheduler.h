@@ -0,0 +1,129 @@
+/*
+  HiTechnicSerialScheduler.h - Non-blocking, prioritized serial output
+
+  Serial.print() blocks as soon as the 64-byte hardware TX buffer is full:
+  at 57600 baud a 100-byte telemetry line holds up loop() for several
+  milliseconds. A HiTechnicSerialScheduler is a Print that queues whole
+  frames in RAM instead and hands bytes to the port only as fast as
+  availableForWrite() says they fit, from update() in loop(). Writing to
+  it never waits.
+
+  Every frame has a priority, each with its own ring in one
+  HT_TX_BUFFER_SIZE pool (split with setCapacity()):
+
+    HT_TX_ACK        Sent first; dropped only if its ring is full
+    HT_TX_TELEMETRY  When its ring is full, telemetry frames still waiting
+                     are discarded for the newer one (coalesced)
+    HT_TX_DEBUG      Sent last; a new frame that does not fit is dropped
+
+  A frame that started going out is always finished before another one
+  starts, so frames are never interleaved or cut. Binary frames are
+  delimited with beginFrame()/endFrame(); text written outside them is
+  framed per line at the setPriority() priority. Dropped bytes, dropped
+  frames and the high-water mark of each ring are counted.
+
+  The port must implement availableForWrite() (HardwareSerial does).
+
+  Usage:
+    HiTechnicSerialScheduler out(Serial1);
+    HiTechnicProtocol link(out);
+
+    out.beginFrame(HT_TX_ACK);
+    link.sendAck();
+    out.endFrame();
+
+    out.setPriority(HT_TX_TELEMETRY);
+    out.println("TELEM,...");
+
+    loop: out.update();
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicSerialScheduler_h
+#define HiTechnicSerialScheduler_h
+
+#include "Arduino.h"
+
+// Frame priorities, highest first
+#define HT_TX_ACK        0
+#define HT_TX_TELEMETRY  1
+#define HT_TX_DEBUG      2
+#define HT_TX_PRIORITIES 3
+
+// Queue memory shared by the three rings
+#ifndef HT_TX_BUFFER_SIZE
+#define HT_TX_BUFFER_SIZE 256
+#endif
+
+// Longest frame (payload bytes)
+#define HT_TX_MAX_FRAME 255
+
+// One priority's ring inside the pool. Frames are stored as a length byte
+// and the payload; the frame being sent has its length byte removed.
+struct HiTechnicTxRing {
+  uint16_t start;              // Offset in the pool
+  uint16_t size;
+  uint16_t head;               // Oldest byte, relative to start
+  uint16_t count;              // Bytes held, including a frame being built
+  uint16_t committed;          // Bytes of finished frames (and the one being sent)
+  uint16_t highWater;
+  uint32_t droppedBytes;
+  uint32_t droppedFrames;
+};
+
+class HiTechnicSerialScheduler : public Print {
+  public:
+    HiTechnicSerialScheduler(Print& out);
+
+    // Split the pool between the rings (sum at most HT_TX_BUFFER_SIZE).
+    // Default 64 / 128 / 64. Drops anything queued.
+    bool setCapacity(uint16_t ack, uint16_t telemetry, uint16_t debug);
+
+    // Explicit frame: everything written until endFrame() is queued, or
+    // dropped, as one unit. endFrame() returns false if it was dropped.
+    void beginFrame(uint8_t priority);
+    bool endFrame();
+
+    // Priority of text written outside beginFrame()/endFrame(); each line
+    // ('\n') is one frame. Applies from the next line.
+    void setPriority(uint8_t priority);
+
+    // Move queued bytes to the port without blocking; call every loop()
+    void update();
+
+    size_t write(uint8_t data);
+    using Print::write;
+
+    // Bytes queued (all rings, or one priority)
+    uint16_t getQueued();
+    uint16_t getQueued(uint8_t priority);
+
+    // Counters per priority since the last resetCounters()
+    uint32_t getDroppedBytes(uint8_t priority);
+    uint32_t getDroppedFrames(uint8_t priority);
+    uint16_t getHighWaterMark(uint8_t priority);
+    void resetCounters();
+
+  private:
+    Print* _out;
+    uint8_t _pool[HT_TX_BUFFER_SIZE];
+    HiTechnicTxRing _rings[HT_TX_PRIORITIES];
+
+    uint8_t _priority;           // For line frames
+
+    // Frame being built
+    int8_t _building;            // Ring, -1 if none
+    bool _lineFrame;             // Opened by write(), closed by '\n'
+    bool _overflow;              // Did not fit, dropped at endFrame()
+    uint16_t _frameLength;       // Payload bytes written so far
+
+    // Frame being sent
+    int8_t _active;              // Ring, -1 if none
+    uint8_t _remaining;
+
+    uint16_t position(HiTechnicTxRing& ring, uint16_t offset);
+    void coalesce(HiTechnicTxRing& ring);
+};
+
+#endif
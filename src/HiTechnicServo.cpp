@@ -6,27 +6,36 @@
 #include "HiTechnicServo.h"
 
 // Constructor
-HiTechnicServo::HiTechnicServo(uint8_t address) {
+HiTechnicServo::HiTechnicServo(uint8_t address, HiTechnicBus& bus) {
   _address = address;
+  _bus = &bus;
+  _lastWriteTime = 0;
+  _asyncWrites = 0;
   _pwmMode = 0xAA; // Default to no timeout mode
   // Initialize position tracking to center
   for (int i = 0; i < 6; i++) {
     _servoPositions[i] = SERVO_CENTER;
   }
+  invalidateShadow();
+  _autoFlush = true;
 }
 
 // Initialize the servo controller
 void HiTechnicServo::begin(uint8_t pwmMode) {
-  Wire.begin();
+  _bus->begin();
   delay(100); // Allow controller to initialize
   
+  // Controller state is unknown until every register has been written once
+  invalidateShadow();
+  
   // Store PWM mode preference
   _pwmMode = pwmMode;
   
   // Enable PWM outputs
   // 0xAA = enable without timeout (default)
   // 0x00 = enable with 10-second timeout (requires periodic refresh)
-  writeRegister(HT_SERVO_PWM_ENABLE, _pwmMode);
+  setShadow(HT_SERVO_PWM_ENABLE, _pwmMode);
+  flush();
   delay(50);
   
   // Set step time to moderate speed (5)
@@ -34,6 +43,9 @@ void HiTechnicServo::begin(uint8_t pwmMode) {
   
   // Center all servos
   centerAll();
+  
+  // Settings above are only staged when auto flush is off
+  flush();
 }
 
 // Set servo position (0-255)
@@ -44,12 +56,42 @@ void HiTechnicServo::setServoPosition(uint8_t servo, uint8_t position) {
   position = constrain(position, SERVO_MIN_POS, SERVO_MAX_POS);
   
   uint8_t reg = getServoRegister(servo);
-  writeRegister(reg, position);
+  setShadow(reg, position);
+  if (_autoFlush) {
+    flush();
+  }
   
   // Update tracking
   _servoPositions[servo - 1] = position;
 }
 
+// Set all six servo positions in one burst (0x42-0x47)
+void HiTechnicServo::setAllServoPositions(const uint8_t positions[6], bool refresh) {
+  setServoPositions(0x3F, positions, refresh);
+}
+
+// Set the servos selected by mask (bit 0 = servo 1) in one burst
+void HiTechnicServo::setServoPositions(uint8_t mask, const uint8_t positions[6], bool refresh) {
+  for (uint8_t i = 0; i < 6; i++) {
+    if (mask & (1 << i)) {
+      setShadow(HT_SERVO1_POS + i, positions[i]);
+      _servoPositions[i] = positions[i];
+    }
+  }
+  
+  // PWM enable (0x48) directly follows servo 6, so the timeout refresh
+  // costs one extra byte in the same transaction
+  if (refresh) {
+    setShadow(HT_SERVO_PWM_ENABLE, _pwmMode);
+    _shadowDirty |= shadowBit(HT_SERVO_PWM_ENABLE);
+  }
+  
+  // Bridge any clean servos between selected ones so it stays one burst
+  if (_autoFlush) {
+    flushMerged(HT_SERVO_SHADOW_SIZE, false);
+  }
+}
+
 // Set servo position using angle (0-180 degrees)
 void HiTechnicServo::setServoAngle(uint8_t servo, uint8_t angle) {
   // Constrain angle to 0-180
@@ -65,7 +107,10 @@ void HiTechnicServo::setServoAngle(uint8_t servo, uint8_t angle) {
 void HiTechnicServo::setStepTime(uint8_t stepTime) {
   // Constrain to valid range
   stepTime = constrain(stepTime, 0, 15);
-  writeRegister(HT_SERVO_STEP_TIME, stepTime);
+  setShadow(HT_SERVO_STEP_TIME, stepTime);
+  if (_autoFlush) {
+    flush();
+  }
 }
 
 // Get current servo position
@@ -83,9 +128,11 @@ void HiTechnicServo::centerServo(uint8_t servo) {
 
 // Center all servos
 void HiTechnicServo::centerAll() {
-  for (uint8_t i = 1; i <= 6; i++) {
-    centerServo(i);
-  }
+  const uint8_t center[6] = {
+    SERVO_CENTER, SERVO_CENTER, SERVO_CENTER,
+    SERVO_CENTER, SERVO_CENTER, SERVO_CENTER
+  };
+  setAllServoPositions(center);
 }
 
 // Read firmware version
@@ -103,7 +150,10 @@ void HiTechnicServo::disableServo(uint8_t servo) {
   if (servo < 1 || servo > 6) return;
   
   uint8_t reg = getServoRegister(servo);
-  writeRegister(reg, 255);
+  setShadow(reg, 255);
+  if (_autoFlush) {
+    flush();
+  }
 }
 
 // Enable servo (restore last position)
@@ -116,7 +166,120 @@ void HiTechnicServo::enableServo(uint8_t servo) {
 
 // Refresh PWM enable (call periodically when using 0x00 timeout mode)
 void HiTechnicServo::refreshPWM() {
-  writeRegister(HT_SERVO_PWM_ENABLE, _pwmMode);
+  // The refresh is the write itself, so send it even if the value is unchanged
+  setShadow(HT_SERVO_PWM_ENABLE, _pwmMode);
+  _shadowDirty |= shadowBit(HT_SERVO_PWM_ENABLE);
+  if (_autoFlush) {
+    flush();
+  }
+}
+
+// Write every shadow register that changed since the last flush
+void HiTechnicServo::flush() {
+  flushMerged(HT_SERVO_SHADOW_MERGE_GAP, false);
+}
+
+// Queue every changed shadow register on the async engine
+bool HiTechnicServo::flushAsync() {
+  if (!usesAsyncBus() || !isReady()) {
+    return false;
+  }
+  return flushMerged(HT_SERVO_SHADOW_MERGE_GAP, true);
+}
+
+// The async engine drives the hardware TWI behind the global Wire only
+bool HiTechnicServo::usesAsyncBus() {
+  return _bus == &HTWireBus;
+}
+
+// The write gap starts when the write leaves the bus, not when it is queued
+void HiTechnicServo::onWrite(void* context, uint8_t) {
+  HiTechnicServo* servo = (HiTechnicServo*)context;
+  servo->_lastWriteTime = micros();
+  servo->_asyncWrites--;
+}
+
+// Merge dirty bytes into as few bursts as possible, bridging up to
+// maxGap clean bytes whose value is known
+// Returns false if the async queue filled up (remaining bytes stay dirty)
+bool HiTechnicServo::flushMerged(uint8_t maxGap, bool async) {
+  uint8_t i = 0;
+  while (i < HT_SERVO_SHADOW_SIZE) {
+    if (!(_shadowDirty & (1 << i))) {
+      i++;
+      continue;
+    }
+    
+    uint8_t last = i;
+    uint8_t j = i + 1;
+    while (j < HT_SERVO_SHADOW_SIZE) {
+      uint8_t mask = 1 << j;
+      if (_shadowDirty & mask) {
+        last = j;
+      } else if (!(_shadowValid & mask) || j - last > maxGap) {
+        break;
+      }
+      j++;
+    }
+    
+    if (!writeShadowRange(i, last - i + 1, async)) {
+      return false;
+    }
+    i = last + 1;
+  }
+  
+  return true;
+}
+
+// Choose whether setters write immediately or wait for flush()
+void HiTechnicServo::setAutoFlush(bool enabled) {
+  _autoFlush = enabled;
+}
+
+// Check if any shadow register is waiting to be written
+bool HiTechnicServo::hasPendingWrites() {
+  return _shadowDirty != 0;
+}
+
+// Forget what the controller holds so the next flush rewrites everything
+void HiTechnicServo::invalidateShadow() {
+  _shadowValid = 0;
+  _shadowDirty = 0;
+}
+
+// Stage a register in the shadow file, marking it dirty only if it changed
+void HiTechnicServo::setShadow(uint8_t reg, uint8_t value) {
+  uint8_t index = reg - HT_SERVO_SHADOW_START;
+  uint8_t mask = 1 << index;
+  
+  if (!(_shadowValid & mask) || _shadow[index] != value) {
+    _shadow[index] = value;
+    _shadowDirty |= mask;
+  }
+}
+
+// Mask bit for a register in the shadow file
+uint8_t HiTechnicServo::shadowBit(uint8_t reg) {
+  return 1 << (reg - HT_SERVO_SHADOW_START);
+}
+
+// Burst-write part of the shadow file and mark it clean
+bool HiTechnicServo::writeShadowRange(uint8_t index, uint8_t length, bool async) {
+  if (async) {
+    _asyncWrites++;
+    if (!HTAsyncI2C.write(_address, HT_SERVO_SHADOW_START + index, _shadow + index, length,
+                          onWrite, this)) {
+      _asyncWrites--;
+      return false;
+    }
+  } else {
+    writeRegisters(HT_SERVO_SHADOW_START + index, _shadow + index, length);
+  }
+  
+  uint8_t mask = (uint8_t)(((uint16_t)1 << (index + length)) - ((uint16_t)1 << index));
+  _shadowValid |= mask;
+  _shadowDirty &= ~mask;
+  return true;
 }
 
 // Get register address for servo number
@@ -132,24 +295,41 @@ uint8_t HiTechnicServo::getServoRegister(uint8_t servo) {
   }
 }
 
-// Write single byte to register
-void HiTechnicServo::writeRegister(uint8_t reg, uint8_t value) {
-  Wire.beginTransmission(_address);
-  Wire.write(reg);
-  Wire.write(value);
-  Wire.endTransmission();
-  delay(1); // Small delay for I2C
+// Check if the controller has finished its post-write gap
+bool HiTechnicServo::isReady() {
+  return _asyncWrites == 0 && micros() - _lastWriteTime >= HT_I2C_WRITE_GAP_US;
+}
+
+// Wait out the remainder of the post-write gap for this controller only.
+// The earliest next access is _lastWriteTime + HT_I2C_WRITE_GAP_US; the
+// unsigned difference keeps the check correct across micros() rollover.
+// On the Wire bus, queued async transactions are finished first so they
+// never overlap a blocking one.
+void HiTechnicServo::waitForDevice() {
+  if (usesAsyncBus()) {
+    HTAsyncI2C.waitIdle();
+  }
+  while (!isReady()) {
+    yield();
+  }
+}
+
+// Write consecutive registers in one auto-incrementing transaction
+void HiTechnicServo::writeRegisters(uint8_t reg, const uint8_t* data, uint8_t length) {
+  waitForDevice();
+  _bus->beginTransmission(_address);
+  _bus->write(reg);
+  for (uint8_t i = 0; i < length; i++) {
+    _bus->write(data[i]);
+  }
+  _bus->endTransmission();
+  _lastWriteTime = micros();
 }
 
 // Read single byte from register
 uint8_t HiTechnicServo::readRegister(uint8_t reg) {
-  Wire.beginTransmission(_address);
-  Wire.write(reg);
-  Wire.endTransmission();
-  
-  Wire.requestFrom(_address, (uint8_t)1);
-  if (Wire.available()) {
-    return Wire.read();
-  }
-  return 0;
+  waitForDevice();
+  uint8_t value = 0;
+  _bus->writeThenRead(_address, reg, &value, 1);
+  return value;
 }
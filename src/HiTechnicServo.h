@@ -14,7 +14,8 @@
 #define HiTechnicServo_h
 
 #include "Arduino.h"
-#include <Wire.h>
+#include "HiTechnicBus.h"
+#include "HiTechnicAsyncI2C.h"
 
 // Register addresses for HiTechnic Servo Controller
 #define HT_SERVO_VERSION      0x00  // Version number
@@ -30,6 +31,16 @@
 #define HT_SERVO6_POS         0x47  // Servo 6 position
 #define HT_SERVO_PWM_ENABLE   0x48  // PWM enable (0x00=enable+timeout, 0xFF=disable, 0xAA=enable no timeout)
 
+// Shadow register file: STEP_TIME through PWM_ENABLE (0x41-0x48)
+#define HT_SERVO_SHADOW_START HT_SERVO_STEP_TIME
+#define HT_SERVO_SHADOW_SIZE  8
+
+// Clean bytes bridged between two dirty runs instead of starting a new
+// transaction (each transaction costs START, address, register and STOP)
+#ifndef HT_SERVO_SHADOW_MERGE_GAP
+#define HT_SERVO_SHADOW_MERGE_GAP 2
+#endif
+
 // Servo selection
 #define SERVO_1 1
 #define SERVO_2 2
@@ -45,8 +56,9 @@
 
 class HiTechnicServo {
   public:
-    // Constructor - specify I2C address (default 0x04)
-    HiTechnicServo(uint8_t address = 0x04);
+    // Constructor - specify I2C address (default 0x04) and optionally the
+    // bus the controller is on (default: hardware Wire)
+    HiTechnicServo(uint8_t address = 0x04, HiTechnicBus& bus = HTWireBus);
     
     // Initialize the servo controller
     // pwmMode: 0xAA = no timeout (default), 0x00 = 10-second timeout
@@ -55,6 +67,15 @@ class HiTechnicServo {
     // Set servo position (0-255, where 127 is typically center)
     void setServoPosition(uint8_t servo, uint8_t position);
     
+    // Set all six servo positions in a single transaction
+    // refresh: also rewrite PWM enable (0x48) in the same burst, which
+    // refreshes the 10-second timeout when using 0x00 mode
+    void setAllServoPositions(const uint8_t positions[6], bool refresh = false);
+    
+    // Set the servos selected by mask (bit 0 = servo 1 ... bit 5 = servo 6)
+    // in a single transaction; positions[] is indexed by servo - 1
+    void setServoPositions(uint8_t mask, const uint8_t positions[6], bool refresh = false);
+    
     // Set servo position using angle in degrees (0-180)
     void setServoAngle(uint8_t servo, uint8_t angle);
     
@@ -86,15 +107,60 @@ class HiTechnicServo {
     // Refresh PWM enable (call periodically when using 0x00 timeout mode)
     void refreshPWM();
     
+    // Write registers that changed since the last flush, merged into the
+    // fewest bursts. Setters call this automatically; unchanged values
+    // produce no bus writes.
+    void flush();
+    
+    // Queue pending register changes on HTAsyncI2C instead of blocking
+    // Returns false if the controller is not isReady(), the queue filled
+    // up (the rest stays pending) or the controller is not on the default
+    // Wire bus
+    bool flushAsync();
+    
+    // Setters write immediately by default; with auto flush off they only
+    // stage values until flush() or flushAsync() is called
+    void setAutoFlush(bool enabled);
+    
+    // Check if any register change is waiting to be written
+    bool hasPendingWrites();
+    
+    // Forget cached register values so the next flush rewrites them
+    // (use after writing to the controller outside this class)
+    void invalidateShadow();
+    
+    // Check if the controller can be accessed without waiting
+    // (false while an async write is queued, and for HT_I2C_WRITE_GAP_US
+    // after each write completes)
+    bool isReady();
+    
   private:
     uint8_t _address;
+    HiTechnicBus* _bus;
+    unsigned long _lastWriteTime; // micros() of the last completed write
+    uint8_t _asyncWrites; // Queued async writes not yet completed
     uint8_t _pwmMode; // Store PWM mode (0xAA or 0x00)
     uint8_t _servoPositions[6]; // Track last known positions
     
+    // Shadow of the writable registers 0x41-0x48
+    uint8_t _shadow[HT_SERVO_SHADOW_SIZE];
+    uint8_t _shadowValid;  // Bytes known to match the controller
+    uint8_t _shadowDirty;  // Bytes changed since the last flush
+    bool _autoFlush;       // Setters flush immediately
+    
     // I2C communication helpers
-    void writeRegister(uint8_t reg, uint8_t value);
+    void waitForDevice();
+    void writeRegisters(uint8_t reg, const uint8_t* data, uint8_t length);
     uint8_t readRegister(uint8_t reg);
     uint8_t getServoRegister(uint8_t servo);
+    
+    // Shadow register helpers
+    void setShadow(uint8_t reg, uint8_t value);
+    uint8_t shadowBit(uint8_t reg);
+    bool writeShadowRange(uint8_t index, uint8_t length, bool async);
+    bool flushMerged(uint8_t maxGap, bool async);
+    bool usesAsyncBus();
+    static void onWrite(void* context, uint8_t status);
 };
 
 #endif
@@ -0,0 +1,241 @@
+/*
+  HiTechnicTelemetryStream.cpp - Delta-compressed motor telemetry
+*/
+
+#include "HiTechnicTelemetryStream.h"
+
+#define HT_DELTA_STATUS  0x40  // otherMask bits
+#define HT_DELTA_BATTERY 0x80
+
+// Constructor
+HiTechnicTelemetryStream::HiTechnicTelemetryStream(HiTechnicProtocol& link) {
+  _link = &link;
+  _interval = HT_TELEMETRY_KEYFRAME_INTERVAL;
+  _keyframeCount = 0;
+  _deltaCount = 0;
+  _deltaErrors = 0;
+  reset();
+}
+
+void HiTechnicTelemetryStream::setKeyframeInterval(uint8_t frames) {
+  _interval = (frames > 0) ? frames : 1;
+}
+
+void HiTechnicTelemetryStream::reset() {
+  _keyValid[0] = false;
+  _keyValid[1] = false;
+  _current = 0;
+  _sinceKeyframe = 0;
+}
+
+// A keyframe starts on the first call and whenever the interval is up;
+// otherwise a delta against the acknowledged one, or a full frame before
+// the first ack
+size_t HiTechnicTelemetryStream::send(const HiTechnicMotorTelemetry& telemetry) {
+  if ((!_keyValid[0] && !_keyValid[1]) || _sinceKeyframe >= _interval) {
+    return sendKeyframe(telemetry);
+  }
+
+  if (_sinceKeyframe < 255) {
+    _sinceKeyframe++;
+  }
+  if (!_keyValid[_current]) {
+    return _link->sendTelemetry(telemetry);
+  }
+  return sendDelta(telemetry);
+}
+
+size_t HiTechnicTelemetryStream::sendKeyframe(const HiTechnicMotorTelemetry& telemetry) {
+  uint8_t pending = _current ^ 1;
+  _keyframes[pending] = telemetry;
+  _keySequence[pending] = _link->getNextSequence();
+  _keyValid[pending] = true;
+  _sinceKeyframe = 1;
+  _keyframeCount++;
+  return _link->sendTelemetry(telemetry, HT_MSG_TELEMETRY_KEYFRAME);
+}
+
+size_t HiTechnicTelemetryStream::sendDelta(const HiTechnicMotorTelemetry& telemetry) {
+  const HiTechnicMotorTelemetry& key = _keyframes[_current];
+  uint8_t payload[HT_TELEMETRY_DELTA_MAX_LENGTH];
+  uint8_t encoderMask = 0;
+  uint8_t otherMask = 0;
+  uint8_t length = 3;
+
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    // Difference modulo 2^32, so a wrapped encoder still round-trips
+    int32_t delta = (int32_t)((uint32_t)telemetry.encoders[i] - (uint32_t)key.encoders[i]);
+    if (delta != 0) {
+      encoderMask |= 1 << i;
+      length += writeVarint(payload + length, delta);
+    }
+  }
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    if (telemetry.powers[i] != key.powers[i]) {
+      otherMask |= 1 << i;
+      payload[length++] = (uint8_t)telemetry.powers[i];
+    }
+  }
+  if (telemetry.status != key.status) {
+    otherMask |= HT_DELTA_STATUS;
+    payload[length++] = telemetry.status;
+  }
+  if (telemetry.batteryVoltage != key.batteryVoltage) {
+    otherMask |= HT_DELTA_BATTERY;
+    length += writeVarint(payload + length, (int32_t)telemetry.batteryVoltage - key.batteryVoltage);
+  }
+
+  payload[0] = _keySequence[_current];
+  payload[1] = encoderMask;
+  payload[2] = otherMask;
+  _deltaCount++;
+  return _link->sendFrame(HT_MSG_TELEMETRY_DELTA, payload, length);
+}
+
+// Payload of HT_MSG_ACK: acknowledged id, its sequence, status
+bool HiTechnicTelemetryStream::handleFrame() {
+  if (_link->getMessageId() != HT_MSG_ACK || _link->getLength() < 3) {
+    return false;
+  }
+  const uint8_t* payload = _link->getPayload();
+  if (payload[0] != HT_MSG_TELEMETRY_KEYFRAME) {
+    return false;
+  }
+
+  uint8_t pending = _current ^ 1;
+  if (payload[2] == HT_ACK_OK && _keyValid[pending] && payload[1] == _keySequence[pending]) {
+    // The waiting keyframe becomes the reference; the old reference's
+    // slot takes the next keyframe
+    _current = pending;
+    _keyValid[pending ^ 1] = false;
+  }
+  return true;
+}
+
+bool HiTechnicTelemetryStream::receive(HiTechnicMotorTelemetry& telemetry) {
+  switch (_link->getMessageId()) {
+    case HT_MSG_MOTOR_TELEMETRY:
+      return _link->readTelemetry(telemetry);
+
+    case HT_MSG_TELEMETRY_KEYFRAME: {
+      if (!_link->readTelemetry(telemetry)) {
+        return false;
+      }
+      // Keep the keyframe the sender's deltas still refer to; a new one
+      // only replaces the other slot
+      uint8_t slot = _current ^ 1;
+      _keyframes[slot] = telemetry;
+      _keySequence[slot] = _link->getSequence();
+      _keyValid[slot] = true;
+      _keyframeCount++;
+      _link->sendAck(HT_ACK_OK);
+      return true;
+    }
+
+    case HT_MSG_TELEMETRY_DELTA:
+      if (decodeDelta(telemetry)) {
+        _deltaCount++;
+        return true;
+      }
+      _deltaErrors++;
+      return false;
+  }
+  return false;
+}
+
+bool HiTechnicTelemetryStream::decodeDelta(HiTechnicMotorTelemetry& telemetry) {
+  const uint8_t* payload = _link->getPayload();
+  uint8_t length = _link->getLength();
+  if (length < 3) {
+    return false;
+  }
+
+  int8_t slot = -1;
+  for (uint8_t i = 0; i < 2; i++) {
+    if (_keyValid[i] && _keySequence[i] == payload[0]) {
+      slot = i;
+    }
+  }
+  if (slot < 0) {
+    return false;
+  }
+  _current = slot;
+
+  HiTechnicMotorTelemetry result = _keyframes[slot];
+  uint8_t encoderMask = payload[1];
+  uint8_t otherMask = payload[2];
+  uint8_t index = 3;
+
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    if (encoderMask & (1 << i)) {
+      int32_t delta;
+      uint8_t used = readVarint(payload + index, length - index, delta);
+      if (used == 0) {
+        return false;
+      }
+      index += used;
+      result.encoders[i] = (int32_t)((uint32_t)result.encoders[i] + (uint32_t)delta);
+    }
+  }
+  for (uint8_t i = 0; i < HT_PROTOCOL_MOTORS; i++) {
+    if (otherMask & (1 << i)) {
+      if (index >= length) {
+        return false;
+      }
+      result.powers[i] = (int8_t)payload[index++];
+    }
+  }
+  if (otherMask & HT_DELTA_STATUS) {
+    if (index >= length) {
+      return false;
+    }
+    result.status = payload[index++];
+  }
+  if (otherMask & HT_DELTA_BATTERY) {
+    int32_t delta;
+    if (readVarint(payload + index, length - index, delta) == 0) {
+      return false;
+    }
+    result.batteryVoltage = (uint16_t)(result.batteryVoltage + delta);
+  }
+
+  telemetry = result;
+  return true;
+}
+
+uint32_t HiTechnicTelemetryStream::getKeyframeCount() {
+  return _keyframeCount;
+}
+
+uint32_t HiTechnicTelemetryStream::getDeltaCount() {
+  return _deltaCount;
+}
+
+uint32_t HiTechnicTelemetryStream::getDeltaErrors() {
+  return _deltaErrors;
+}
+
+// Zigzag maps small magnitudes of either sign to small codes
+// (0, -1, 1, -2 -> 0, 1, 2, 3)
+uint8_t HiTechnicTelemetryStream::writeVarint(uint8_t* data, int32_t value) {
+  uint32_t code = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  uint8_t length = 0;
+  while (code >= 0x80) {
+    data[length++] = (uint8_t)(code | 0x80);
+    code >>= 7;
+  }
+  data[length++] = (uint8_t)code;
+  return length;
+}
+
+uint8_t HiTechnicTelemetryStream::readVarint(const uint8_t* data, uint8_t length, int32_t& value) {
+  uint32_t code = 0;
+  for (uint8_t i = 0; i < length && i < 5; i++) {
+    code |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+    if (!(data[i] & 0x80)) {
+      value = (int32_t)(code >> 1) ^ -(int32_t)(code & 1);
+      return i + 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,117 @@
+/*
+  HiTechnicTelemetryStream.h - Delta-compressed motor telemetry over a
+  HiTechnicProtocol link
+
+  Most telemetry frames are HT_MSG_TELEMETRY_DELTA frames carrying only
+  what changed since a keyframe the receiver has acknowledged:
+
+    keySequence  encoderMask  otherMask  fields...
+
+  keySequence is the sequence number of the reference keyframe, a
+  HT_MSG_TELEMETRY_KEYFRAME frame (laid out like HT_MSG_MOTOR_TELEMETRY)
+  that the receiver stores and acknowledges. Bit n of encoderMask is set
+  when encoder n differs from the keyframe; its difference follows as a
+  zigzag varint (7 bits per byte, low bits first). Bit n of otherMask
+  (n < 6) is set when power n differs; the power byte follows the
+  encoders. Bit 6 adds the status byte and bit 7 the battery difference
+  as a zigzag varint.
+  An idle motor therefore costs nothing, and a moving one usually 1-3
+  bytes, so six moving motors fit in about 25 bytes instead of 40.
+
+  The receiver acknowledges each keyframe with HT_MSG_ACK (the keyframe's
+  id and sequence); only then does the sender switch its deltas over to
+  it, and until the first acknowledgment it sends full
+  HT_MSG_MOTOR_TELEMETRY frames. A new keyframe goes out every
+  HT_TELEMETRY_KEYFRAME_INTERVAL frames so deltas stay short and a
+  receiver that lost sync recovers. The receiver keeps two keyframes:
+  the one the latest delta referred to and the newest, so deltas still
+  decode while an acknowledgment is on its way or after it was lost.
+
+  Usage (sender):
+    HiTechnicProtocol link(Serial1);
+    HiTechnicTelemetryStream stream(link);
+
+    while (Serial1.available()) {
+      if (link.parse(Serial1.read()) && !stream.handleFrame()) { ... }
+    }
+    stream.send(telemetry);
+
+  Usage (receiver):
+    if (link.parse(data) && stream.receive(telemetry)) { ... }
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicTelemetryStream_h
+#define HiTechnicTelemetryStream_h
+
+#include "Arduino.h"
+#include "HiTechnicProtocol.h"
+
+// Frames between keyframes
+#ifndef HT_TELEMETRY_KEYFRAME_INTERVAL
+#define HT_TELEMETRY_KEYFRAME_INTERVAL 50
+#endif
+
+// keySequence, two masks, six 5-byte varints, six powers, status and a
+// 3-byte varint
+#define HT_TELEMETRY_DELTA_MAX_LENGTH (3 + HT_PROTOCOL_MOTORS * 6 + 4)
+
+class HiTechnicTelemetryStream {
+  public:
+    HiTechnicTelemetryStream(HiTechnicProtocol& link);
+
+    // Frames between keyframes (default HT_TELEMETRY_KEYFRAME_INTERVAL)
+    void setKeyframeInterval(uint8_t frames);
+
+    // Sender: send telemetry as a keyframe or a delta; returns bytes
+    // written
+    size_t send(const HiTechnicMotorTelemetry& telemetry);
+
+    // Sender: call for every frame the link receives. Returns true if it
+    // was a keyframe acknowledgment (consumed here).
+    bool handleFrame();
+
+    // Receiver: call for every frame the link receives. Returns true and
+    // fills telemetry for a full frame, a keyframe (which is
+    // acknowledged) or a delta against a known keyframe.
+    bool receive(HiTechnicMotorTelemetry& telemetry);
+
+    // Force a keyframe on the next send() and forget the reference
+    void reset();
+
+    // Statistics
+    uint32_t getKeyframeCount();   // Keyframes sent or received
+    uint32_t getDeltaCount();      // Deltas sent or decoded
+    uint32_t getDeltaErrors();     // Receiver: unknown keyframe or bad payload
+
+    // Zigzag varint coding; write returns bytes written (1-5), read
+    // returns bytes consumed (0 if truncated)
+    static uint8_t writeVarint(uint8_t* data, int32_t value);
+    static uint8_t readVarint(const uint8_t* data, uint8_t length, int32_t& value);
+
+  private:
+    HiTechnicProtocol* _link;
+
+    // Keyframe slots. Sender: _current is the acknowledged reference and
+    // the other slot the keyframe waiting for its ack. Receiver: _current
+    // is the keyframe the last delta referred to and the other slot the
+    // newest one.
+    HiTechnicMotorTelemetry _keyframes[2];
+    uint8_t _keySequence[2];
+    bool _keyValid[2];
+    uint8_t _current;
+
+    uint8_t _interval;
+    uint8_t _sinceKeyframe;
+
+    uint32_t _keyframeCount;
+    uint32_t _deltaCount;
+    uint32_t _deltaErrors;
+
+    size_t sendKeyframe(const HiTechnicMotorTelemetry& telemetry);
+    size_t sendDelta(const HiTechnicMotorTelemetry& telemetry);
+    bool decodeDelta(HiTechnicMotorTelemetry& telemetry);
+};
+
+#endif
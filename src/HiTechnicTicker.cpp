@@ -0,0 +1,168 @@
+/*
+  HiTechnicTicker.cpp - Fixed-rate control tick with deadline and jitter
+  statistics
+*/
+
+#include "HiTechnicTicker.h"
+
+// Constructor
+HiTechnicTicker::HiTechnicTicker(uint16_t periodMs) {
+  storePeriod(periodMs);
+  _deadline = 0;
+  _tickStart = 0;
+  _started = false;
+  _inTick = false;
+  _tickOverrun = false;
+  resetStats();
+}
+
+void HiTechnicTicker::begin() {
+  _deadline = micros() + _period;
+  _started = true;
+  _inTick = false;
+}
+
+void HiTechnicTicker::setPeriod(uint16_t periodMs) {
+  storePeriod(periodMs);
+  begin();
+}
+
+// A zero period would make due() divide by zero and never run out of
+// ticks, so it is raised to 1 ms
+void HiTechnicTicker::storePeriod(uint16_t periodMs) {
+  if (periodMs == 0) {
+    periodMs = 1;
+  }
+  _period = (uint32_t)periodMs * 1000UL;
+}
+
+uint16_t HiTechnicTicker::getPeriod() {
+  return _period / 1000UL;
+}
+
+bool HiTechnicTicker::due() {
+  if (!_started) {
+    begin();
+  }
+  
+  unsigned long now = micros();
+  
+  // Signed difference keeps the comparison valid across micros() wrap
+  long late = (long)(now - _deadline);
+  if (late < 0) {
+    return false;
+  }
+  
+  // Too far behind: drop the excess ticks and realign
+  uint32_t missed = (uint32_t)late / _period;
+  if (missed > HT_TICK_MAX_CATCHUP) {
+    uint32_t drop = missed - HT_TICK_MAX_CATCHUP;
+    _skipped += drop;
+    _deadline += drop * _period;
+    late -= drop * _period;
+  }
+  
+  _ticks++;
+  _tickOverrun = ((uint32_t)late >= _period);
+  if (_tickOverrun) {
+    _overruns++;
+  }
+  if ((uint32_t)late > _maxJitter) {
+    _maxJitter = late;
+  }
+  uint32_t bin = (uint32_t)late / HT_TICK_HISTOGRAM_US;
+  if (bin >= HT_TICK_HISTOGRAM_BINS) {
+    bin = HT_TICK_HISTOGRAM_BINS - 1;
+  }
+  if (_histogram[bin] < 0xFFFF) {
+    _histogram[bin]++;
+  }
+  
+  // A tick left open is closed when the next one starts
+  if (_inTick) {
+    done();
+  }
+  
+  // Next deadline is one period after this one, not after now
+  _deadline += _period;
+  _tickStart = now;
+  _inTick = true;
+  return true;
+}
+
+void HiTechnicTicker::done() {
+  if (!_inTick) {
+    return;
+  }
+  _inTick = false;
+  
+  uint32_t elapsed = micros() - _tickStart;
+  if (elapsed < _minTime) {
+    _minTime = elapsed;
+  }
+  if (elapsed > _maxTime) {
+    _maxTime = elapsed;
+  }
+  
+  // Halve the running sums before they overflow; the average is kept
+  if (_totalTime > 0xFFFFFFFFUL - elapsed) {
+    _totalTime /= 2;
+    _timedTicks /= 2;
+  }
+  _totalTime += elapsed;
+  _timedTicks++;
+  
+  // Count a tick at most once, even if it started late and ran long
+  if (elapsed > _period && !_tickOverrun) {
+    _overruns++;
+  }
+}
+
+uint32_t HiTechnicTicker::getTicks() {
+  return _ticks;
+}
+
+uint32_t HiTechnicTicker::getOverruns() {
+  return _overruns;
+}
+
+uint32_t HiTechnicTicker::getSkipped() {
+  return _skipped;
+}
+
+uint32_t HiTechnicTicker::getMinTime() {
+  return (_timedTicks > 0) ? _minTime : 0;
+}
+
+uint32_t HiTechnicTicker::getAvgTime() {
+  return (_timedTicks > 0) ? _totalTime / _timedTicks : 0;
+}
+
+uint32_t HiTechnicTicker::getMaxTime() {
+  return _maxTime;
+}
+
+uint32_t HiTechnicTicker::getMaxJitter() {
+  return _maxJitter;
+}
+
+uint16_t HiTechnicTicker::getHistogram(uint8_t bin) {
+  if (bin >= HT_TICK_HISTOGRAM_BINS) {
+    return 0;
+  }
+  return _histogram[bin];
+}
+
+void HiTechnicTicker::resetStats() {
+  _ticks = 0;
+  _overruns = 0;
+  _skipped = 0;
+  _minTime = 0xFFFFFFFF;
+  _maxTime = 0;
+  _maxJitter = 0;
+  _timedTicks = 0;
+  _totalTime = 0;
+  for (uint8_t i = 0; i < HT_TICK_HISTOGRAM_BINS; i++) {
+    _histogram[i] = 0;
+  }
+}
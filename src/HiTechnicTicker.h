@@ -0,0 +1,105 @@
+/*
+  HiTechnicTicker.h - Fixed-rate control tick with deadline and jitter
+  statistics
+
+  Deadlines advance by exactly one period per tick, measured in micros(),
+  so the control rate does not depend on how often loop() runs. A late
+  loop() catches up by running the missed ticks back to back, up to
+  HT_TICK_MAX_CATCHUP of them; anything further behind is skipped and
+  counted, and the schedule realigns to now.
+
+  Usage:
+    HiTechnicTicker ticker(10);        // 10 ms control period
+
+    void loop() {
+      while (ticker.due()) {
+        // ... control step, exactly one period's worth ...
+        ticker.done();
+      }
+    }
+
+  Each tick records its lateness (start time minus deadline) in a jitter
+  histogram and its work time (due() to done()) in min/avg/max. A tick
+  whose work takes longer than the period, or that starts a full period
+  late, counts as an overrun.
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicTicker_h
+#define HiTechnicTicker_h
+
+#include "Arduino.h"
+
+// Missed ticks run back to back before the schedule realigns
+#ifndef HT_TICK_MAX_CATCHUP
+#define HT_TICK_MAX_CATCHUP 4
+#endif
+
+// Jitter histogram: HT_TICK_HISTOGRAM_BINS bins of HT_TICK_HISTOGRAM_US
+// each; the last bin collects everything later than that
+#ifndef HT_TICK_HISTOGRAM_BINS
+#define HT_TICK_HISTOGRAM_BINS 8
+#endif
+
+#ifndef HT_TICK_HISTOGRAM_US
+#define HT_TICK_HISTOGRAM_US 250
+#endif
+
+class HiTechnicTicker {
+  public:
+    // Period in milliseconds (e.g. 5, 10, 20); 0 is treated as 1
+    HiTechnicTicker(uint16_t periodMs = 20);
+    
+    // Start the schedule: the first tick is due one period from now
+    void begin();
+    
+    // Change the period (0 is treated as 1 ms); the schedule restarts
+    // from now
+    void setPeriod(uint16_t periodMs);
+    uint16_t getPeriod();
+    
+    // True once per elapsed period. Call in a while loop to catch up on
+    // missed deadlines.
+    bool due();
+    
+    // Mark the end of the work for the tick returned by due(). A tick
+    // still open when the next one starts is closed then.
+    void done();
+    
+    // Statistics since the last resetStats()
+    uint32_t getTicks();             // Ticks run
+    uint32_t getOverruns();          // Late starts or work longer than the period
+    uint32_t getSkipped();           // Ticks dropped beyond HT_TICK_MAX_CATCHUP
+    uint32_t getMinTime();           // Work time per tick (µs)
+    uint32_t getAvgTime();
+    uint32_t getMaxTime();
+    uint32_t getMaxJitter();         // Worst lateness (µs)
+    
+    // Ticks whose lateness fell in bin (bin * HT_TICK_HISTOGRAM_US wide)
+    uint16_t getHistogram(uint8_t bin);
+    
+    void resetStats();
+    
+  private:
+    uint32_t _period;                // Microseconds
+    unsigned long _deadline;
+    unsigned long _tickStart;
+    bool _started;
+    bool _inTick;
+    bool _tickOverrun;               // Current tick already counted
+    
+    uint32_t _ticks;
+    uint32_t _overruns;
+    uint32_t _skipped;
+    uint32_t _minTime;
+    uint32_t _maxTime;
+    uint32_t _maxJitter;
+    uint32_t _timedTicks;
+    uint32_t _totalTime;
+    uint16_t _histogram[HT_TICK_HISTOGRAM_BINS];
+    
+    void storePeriod(uint16_t periodMs);
+};
+
+#endif
@@ -0,0 +1,129 @@
+/*
+  HiTechnicTrajectory.cpp - Jerk-limited point-to-point trajectory for one
+  encoder axis
+*/
+
+#include "HiTechnicTrajectory.h"
+
+// Constructor
+HiTechnicTrajectory::HiTechnicTrajectory() {
+  setLimits(HT_TRAJECTORY_VELOCITY, HT_TRAJECTORY_ACCELERATION, HT_TRAJECTORY_JERK);
+  plan(0, 0);
+}
+
+void HiTechnicTrajectory::setLimits(uint32_t velocity, uint32_t acceleration, uint32_t jerk) {
+  _velocity = (velocity > 0) ? velocity : 1;
+  _acceleration = (acceleration > 0) ? acceleration : 1;
+  _jerk = (jerk > 0) ? jerk : 1;
+}
+
+void HiTechnicTrajectory::plan(int32_t start, int32_t goal) {
+  _start = start;
+  _goal = goal;
+  _direction = (goal >= start) ? 1.0 : -1.0;
+  _distance = (goal >= start) ? (float)(goal - start) : (float)(start - goal);
+  _plannedJerk = _jerk;
+  
+  if (_distance <= 0) {
+    _tj = _tca = _ta = _tv = 0;
+    _peakAccel = _peakVelocity = 0;
+    return;
+  }
+  
+  // Acceleration phase to peak velocity v takes Tj = A/J of jerk on each
+  // side of a constant-acceleration stretch, or just two jerk segments if
+  // v is reached before the acceleration limit is
+  float vLimit = _velocity;
+  float aLimit = _acceleration;
+  float j = _jerk;
+  
+  float v = vLimit;
+  float accelThreshold = aLimit * aLimit / j;  // Smallest v that reaches A
+  if (v >= accelThreshold) {
+    // Accelerating to v and back down covers v * (A/J + v/A)
+    if (_distance < v * (aLimit / j + v / aLimit)) {
+      // Solve v^2 / A + v * A / J = D for the peak velocity
+      float b = aLimit / j;
+      v = 0.5 * aLimit * (-b + sqrt(b * b + 4.0 * _distance / aLimit));
+      if (v < accelThreshold) {
+        v = pow(_distance * sqrt(j) / 2.0, 2.0 / 3.0);
+      }
+    }
+  } else if (_distance < 2.0 * v * sqrt(v / j)) {
+    // Without reaching A, accelerating to v and back covers 2 v sqrt(v / J)
+    v = pow(_distance * sqrt(j) / 2.0, 2.0 / 3.0);
+  }
+  
+  if (v < accelThreshold) {
+    _tj = sqrt(v / j);
+    _tca = 0;
+    _peakAccel = j * _tj;
+  } else {
+    _tj = aLimit / j;
+    _tca = v / aLimit - _tj;
+    _peakAccel = aLimit;
+  }
+  
+  _ta = 2.0 * _tj + _tca;
+  _peakVelocity = v;
+  
+  // Whatever the two ramps do not cover is cruised at peak velocity
+  float dAccel = v * _ta / 2.0;
+  float cruise = _distance - 2.0 * dAccel;
+  _tv = (cruise > 0) ? cruise / v : 0;
+}
+
+float HiTechnicTrajectory::accelDistance(float t) {
+  float j = _plannedJerk;
+  if (t < _tj) {
+    return j * t * t * t / 6.0;
+  }
+  
+  float v1 = j * _tj * _tj / 2.0;
+  float s1 = j * _tj * _tj * _tj / 6.0;
+  if (t < _tj + _tca) {
+    float tau = t - _tj;
+    return s1 + v1 * tau + _peakAccel * tau * tau / 2.0;
+  }
+  
+  float s2 = s1 + v1 * _tca + _peakAccel * _tca * _tca / 2.0;
+  float v2 = v1 + _peakAccel * _tca;
+  float tau = t - _tj - _tca;
+  if (tau > _tj) {
+    tau = _tj;
+  }
+  return s2 + v2 * tau + _peakAccel * tau * tau / 2.0 - j * tau * tau * tau / 6.0;
+}
+
+int32_t HiTechnicTrajectory::position(uint32_t elapsed) {
+  float t = elapsed / 1000000.0;
+  float total = 2.0 * _ta + _tv;
+  if (t >= total || _distance <= 0) {
+    return _goal;
+  }
+  
+  // Acceleration, cruise, then the acceleration phase mirrored in time
+  float s;
+  if (t < _ta) {
+    s = accelDistance(t);
+  } else if (t < _ta + _tv) {
+    s = accelDistance(_ta) + _peakVelocity * (t - _ta);
+  } else {
+    s = _distance - accelDistance(total - t);
+  }
+  
+  // Offset from start keeps float precision independent of the position
+  return _start + (int32_t)(_direction * s + (_direction > 0 ? 0.5 : -0.5));
+}
+
+uint32_t HiTechnicTrajectory::getDuration() {
+  return (uint32_t)((2.0 * _ta + _tv) * 1000000.0);
+}
+
+int32_t HiTechnicTrajectory::getStart() {
+  return _start;
+}
+
+int32_t HiTechnicTrajectory::getGoal() {
+  return _goal;
+}
@@ -0,0 +1,77 @@
+/*
+  HiTechnicTrajectory.h - Jerk-limited point-to-point trajectory for one
+  encoder axis
+
+  Plans a rest-to-rest move under velocity, acceleration and jerk limits
+  (seven-segment S-curve: jerk up, constant acceleration, jerk down, cruise,
+  and the mirror image to stop). Short moves that never reach the limits
+  get a lower peak velocity or acceleration instead. position() then gives
+  the encoder target at any time into the move, so a driver can stream
+  intermediate targets instead of handing the whole step to the
+  controller's own position loop.
+
+  Units are encoder counts and seconds: velocity in counts/s,
+  acceleration in counts/s^2, jerk in counts/s^3.
+
+  Created: November 2025
+*/
+
+#ifndef HiTechnicTrajectory_h
+#define HiTechnicTrajectory_h
+
+#include "Arduino.h"
+
+// Default limits (TETRIX encoders: 1440 counts per output revolution)
+#ifndef HT_TRAJECTORY_VELOCITY
+#define HT_TRAJECTORY_VELOCITY 1440UL
+#endif
+#ifndef HT_TRAJECTORY_ACCELERATION
+#define HT_TRAJECTORY_ACCELERATION 2880UL
+#endif
+#ifndef HT_TRAJECTORY_JERK
+#define HT_TRAJECTORY_JERK 14400UL
+#endif
+
+class HiTechnicTrajectory {
+  public:
+    HiTechnicTrajectory();
+    
+    // Velocity, acceleration and jerk limits for future plans
+    void setLimits(uint32_t velocity, uint32_t acceleration, uint32_t jerk);
+    
+    // Plan a move from start to goal, both at rest
+    void plan(int32_t start, int32_t goal);
+    
+    // Encoder target at elapsed microseconds into the move
+    int32_t position(uint32_t elapsed);
+    
+    // Length of the planned move in microseconds
+    uint32_t getDuration();
+    
+    int32_t getStart();
+    int32_t getGoal();
+    
+  private:
+    float _velocity;
+    float _acceleration;
+    float _jerk;
+    
+    int32_t _start;
+    int32_t _goal;
+    float _direction;     // +1 or -1
+    float _distance;      // Counts, always positive
+    
+    // Planned segment times (s) and the peak values actually reached
+    float _tj;            // Each jerk segment
+    float _tca;           // Constant acceleration segment
+    float _ta;            // Whole acceleration phase
+    float _tv;            // Cruise
+    float _peakAccel;
+    float _peakVelocity;
+    float _plannedJerk;
+    
+    // Distance covered t seconds into the acceleration phase
+    float accelDistance(float t);
+};
+
+#endif
@@ -14,9 +14,29 @@ SoftwareI2C::SoftwareI2C(uint8_t sdaPin, uint8_t sclPin) {
   _txBufferIndex = 0;
   _txBufferLength = 0;
   _transmitting = false;
+  _halfPeriod = 5;  // 100kHz
+  _achievedClock = 0;
+  _bitCount = 0;
+  _transactionStart = 0;
 }
 
 void SoftwareI2C::begin() {
+#if defined(__AVR__)
+  // Resolve port registers once so each edge is a couple of instructions
+  // instead of a pinMode()/digitalWrite() lookup
+  uint8_t port = digitalPinToPort(_sdaPin);
+  _sdaDDR = portModeRegister(port);
+  _sdaPort = portOutputRegister(port);
+  _sdaPinReg = portInputRegister(port);
+  _sdaMask = digitalPinToBitMask(_sdaPin);
+  
+  port = digitalPinToPort(_sclPin);
+  _sclDDR = portModeRegister(port);
+  _sclPort = portOutputRegister(port);
+  _sclPinReg = portInputRegister(port);
+  _sclMask = digitalPinToBitMask(_sclPin);
+#endif
+  
   // Set pins as inputs (high impedance) with pullups
   pinMode(_sdaPin, INPUT_PULLUP);
   pinMode(_sclPin, INPUT_PULLUP);
@@ -25,54 +45,119 @@ void SoftwareI2C::begin() {
   delay(10);
 }
 
+void SoftwareI2C::setClock(uint32_t frequency) {
+  if (frequency == SOFT_I2C_CLOCK_MAX) {
+    _halfPeriod = 0;
+  } else {
+    // Half of the clock period; pin toggling overhead makes up the rest
+    uint32_t half = 500000UL / frequency;
+    _halfPeriod = (half > 255) ? 255 : (uint8_t)half;
+  }
+}
+
+uint32_t SoftwareI2C::getClock() {
+  return _achievedClock;
+}
+
 void SoftwareI2C::delayHalf() {
   // Half of I2C clock period (100kHz = 10us period, 5us half)
-  delayMicroseconds(5);
+  if (_halfPeriod > 0) {
+    delayMicroseconds(_halfPeriod);
+  }
+}
+
+void SoftwareI2C::beginTiming() {
+  _bitCount = 0;
+  _transactionStart = micros();
+}
+
+void SoftwareI2C::endTiming() {
+  unsigned long elapsed = micros() - _transactionStart;
+  if (elapsed > 0) {
+    _achievedClock = (uint32_t)_bitCount * 1000000UL / elapsed;
+  }
 }
 
+// Open-drain outputs: release = input with pull-up, low = output driving 0.
+// Port writes are read-modify-write and Mega ports H-L are not bit
+// addressable, so interrupts are held off for the few cycles they take.
 void SoftwareI2C::setSDA(bool high) {
+#if defined(__AVR__)
+  uint8_t oldSREG = SREG;
+  cli();
+  if (high) {
+    *_sdaDDR &= ~_sdaMask;           // Release (pull-up pulls high)
+    *_sdaPort |= _sdaMask;
+  } else {
+    *_sdaPort &= ~_sdaMask;          // Pull low
+    *_sdaDDR |= _sdaMask;
+  }
+  SREG = oldSREG;
+#else
   if (high) {
     pinMode(_sdaPin, INPUT_PULLUP);  // Release (pull-up pulls high)
   } else {
     pinMode(_sdaPin, OUTPUT);
     digitalWrite(_sdaPin, LOW);      // Pull low
   }
-  delayHalf();
+#endif
 }
 
 bool SoftwareI2C::readSDA() {
-  pinMode(_sdaPin, INPUT_PULLUP);
-  delayHalf();
+#if defined(__AVR__)
+  return (*_sdaPinReg & _sdaMask) != 0;
+#else
   return digitalRead(_sdaPin);
+#endif
 }
 
 void SoftwareI2C::setSCL(bool high) {
   if (high) {
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli();
+    *_sclDDR &= ~_sclMask;           // Release
+    *_sclPort |= _sclMask;
+    SREG = oldSREG;
+#else
     pinMode(_sclPin, INPUT_PULLUP);  // Release
+#endif
     // Clock stretching: wait for slave to release SCL
     uint16_t timeout = 1000;
-    while (digitalRead(_sclPin) == LOW && timeout > 0) {
+    while (!readSCL() && timeout > 0) {
       delayMicroseconds(1);
       timeout--;
     }
   } else {
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli();
+    *_sclPort &= ~_sclMask;          // Pull low
+    *_sclDDR |= _sclMask;
+    SREG = oldSREG;
+#else
     pinMode(_sclPin, OUTPUT);
     digitalWrite(_sclPin, LOW);      // Pull low
+#endif
   }
   delayHalf();
 }
 
 bool SoftwareI2C::readSCL() {
-  pinMode(_sclPin, INPUT_PULLUP);
-  delayHalf();
+#if defined(__AVR__)
+  return (*_sclPinReg & _sclMask) != 0;
+#else
   return digitalRead(_sclPin);
+#endif
 }
 
 void SoftwareI2C::startCondition() {
-  // SDA high, SCL high -> SDA goes low while SCL high
+  // SDA high, SCL high -> SDA goes low while SCL high.
+  // From a held bus (SCL low) the same sequence is a repeated START.
   setSDA(true);
   setSCL(true);
   setSDA(false);  // START condition
+  delayHalf();
   setSCL(false);
 }
 
@@ -81,12 +166,16 @@ void SoftwareI2C::stopCondition() {
   setSDA(false);
   setSCL(true);
   setSDA(true);   // STOP condition
+  delayHalf();
 }
 
+// One clock per bit: data changes while SCL is low, each SCL level
+// lasts half a period
 bool SoftwareI2C::writeBit(bool bit) {
   setSDA(bit);
   setSCL(true);   // Clock high - data is read
   setSCL(false);  // Clock low
+  _bitCount++;
   return true;
 }
 
@@ -95,6 +184,7 @@ bool SoftwareI2C::readBit() {
   setSCL(true);   // Clock high
   bool bit = readSDA();
   setSCL(false);  // Clock low
+  _bitCount++;
   return bit;
 }
 
@@ -134,7 +224,7 @@ void SoftwareI2C::beginTransmission(uint8_t address) {
   _transmitting = true;
 }
 
-uint8_t SoftwareI2C::write(uint8_t data) {
+size_t SoftwareI2C::write(uint8_t data) {
   if (_transmitting) {
     if (_txBufferLength < 32) {
       _txBuffer[_txBufferLength++] = data;
@@ -144,7 +234,9 @@ uint8_t SoftwareI2C::write(uint8_t data) {
   return 0;
 }
 
-uint8_t SoftwareI2C::endTransmission() {
+uint8_t SoftwareI2C::endTransmission(bool sendStop) {
+  beginTiming();
+  
   // Send start condition
   startCondition();
   
@@ -162,8 +254,11 @@ uint8_t SoftwareI2C::endTransmission() {
     }
   }
   
-  // Send stop condition
-  stopCondition();
+  // Send stop condition, or keep the bus for a repeated START
+  if (sendStop) {
+    stopCondition();
+  }
+  endTiming();
   
   _txBufferLength = 0;
   _transmitting = false;
@@ -176,6 +271,8 @@ uint8_t SoftwareI2C::requestFrom(uint8_t address, uint8_t quantity) {
     quantity = 32;
   }
   
+  beginTiming();
+  
   // Send start condition
   startCondition();
   
@@ -194,18 +291,19 @@ uint8_t SoftwareI2C::requestFrom(uint8_t address, uint8_t quantity) {
   
   // Send stop condition
   stopCondition();
+  endTiming();
   
   _rxBufferIndex = 0;
   return _rxBufferLength;
 }
 
-uint8_t SoftwareI2C::read() {
+int SoftwareI2C::read() {
   if (_rxBufferIndex < _rxBufferLength) {
     return _rxBuffer[_rxBufferIndex++];
   }
-  return 0;
+  return -1;
 }
 
-uint8_t SoftwareI2C::available() {
+int SoftwareI2C::available() {
   return _rxBufferLength - _rxBufferIndex;
 }
@@ -10,17 +10,32 @@
 #define SOFTWAREI2C_H
 
 #include <Arduino.h>
+#include "HiTechnicBus.h"
 
-class SoftwareI2C {
+// setClock() value for the fastest rate the pins can toggle (no added delay)
+#define SOFT_I2C_CLOCK_MAX 0
+
+// Usable directly or as the bus of a HiTechnicMotor / HiTechnicServo:
+//   SoftwareI2C bus2(30, 31);
+//   HiTechnicMotor motors(0x01, bus2);
+class SoftwareI2C : public HiTechnicBus {
   public:
     SoftwareI2C(uint8_t sdaPin, uint8_t sclPin);
     void begin();
     void beginTransmission(uint8_t address);
-    uint8_t write(uint8_t data);
-    uint8_t endTransmission();
+    size_t write(uint8_t data);
+    uint8_t endTransmission(bool sendStop = true);
     uint8_t requestFrom(uint8_t address, uint8_t quantity);
-    uint8_t read();
-    uint8_t available();
+    int read();
+    int available();
+    
+    // Set the target SCL frequency in Hz (e.g. 100000, 400000) or
+    // SOFT_I2C_CLOCK_MAX. Default 100000.
+    void setClock(uint32_t frequency);
+    
+    // SCL frequency actually achieved by the last transaction (Hz),
+    // including pin toggling overhead and clock stretching
+    uint32_t getClock();
     
   private:
     uint8_t _sdaPin;
@@ -34,6 +49,24 @@ class SoftwareI2C {
     uint8_t _txBufferIndex;
     uint8_t _txBufferLength;
     
+    // Timing
+    uint8_t _halfPeriod;            // Delay per half clock (microseconds)
+    uint32_t _achievedClock;
+    uint16_t _bitCount;             // SCL cycles in the current transaction
+    unsigned long _transactionStart;
+    
+#if defined(__AVR__)
+    // Direct port access, resolved once in begin()
+    volatile uint8_t* _sdaDDR;
+    volatile uint8_t* _sdaPort;
+    volatile uint8_t* _sdaPinReg;
+    uint8_t _sdaMask;
+    volatile uint8_t* _sclDDR;
+    volatile uint8_t* _sclPort;
+    volatile uint8_t* _sclPinReg;
+    uint8_t _sclMask;
+#endif
+    
     // Low-level bit-bang functions
     void setSDA(bool high);
     bool readSDA();
@@ -49,6 +82,8 @@ class SoftwareI2C {
     uint8_t readByte(bool ack);
     
     void delayHalf();
+    void beginTiming();
+    void endTiming();
 };
 
 #endif
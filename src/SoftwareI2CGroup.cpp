@@ -0,0 +1,301 @@
+/*
+ * SoftwareI2CGroup.cpp
+ *
+ * Lockstep bit-banged I2C on one SCL and several SDA lines
+ */
+
+#include "SoftwareI2CGroup.h"
+
+SoftwareI2CGroup::SoftwareI2CGroup(const uint8_t sdaPins[], uint8_t count, uint8_t sclPin) {
+  if (count > SOFT_I2C_GROUP_MAX) {
+    count = SOFT_I2C_GROUP_MAX;
+  }
+  _count = count;
+  for (uint8_t i = 0; i < count; i++) {
+    _sdaPins[i] = sdaPins[i];
+    _sdaMasks[i] = 1 << i;  // Replaced by port bits in begin() on AVR
+  }
+  _sclPin = sclPin;
+  _halfPeriod = 5;  // 100kHz
+  _groupMask = 0;
+}
+
+bool SoftwareI2CGroup::begin() {
+  bool ok = true;
+
+#if defined(__AVR__)
+  // All SDA lines must live on one port so a single register access moves
+  // or samples every bus at once
+  uint8_t port = digitalPinToPort(_sdaPins[0]);
+  _sdaDDR = portModeRegister(port);
+  _sdaPort = portOutputRegister(port);
+  _sdaPinReg = portInputRegister(port);
+  for (uint8_t i = 0; i < _count; i++) {
+    if (digitalPinToPort(_sdaPins[i]) != port) {
+      ok = false;
+    }
+    _sdaMasks[i] = digitalPinToBitMask(_sdaPins[i]);
+  }
+
+  uint8_t sclPort = digitalPinToPort(_sclPin);
+  _sclDDR = portModeRegister(sclPort);
+  _sclPort = portOutputRegister(sclPort);
+  _sclPinReg = portInputRegister(sclPort);
+  _sclMask = digitalPinToBitMask(_sclPin);
+#endif
+
+  _groupMask = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    _groupMask |= _sdaMasks[i];
+  }
+
+#if defined(__AVR__)
+  if (sclPort == port && (_sclMask & _groupMask)) {
+    ok = false;
+  }
+#endif
+
+  if (!ok) {
+    _count = 0;
+    _groupMask = 0;
+    return false;
+  }
+
+  // Set pins as inputs (high impedance) with pullups
+  for (uint8_t i = 0; i < _count; i++) {
+    pinMode(_sdaPins[i], INPUT_PULLUP);
+  }
+  pinMode(_sclPin, INPUT_PULLUP);
+  delay(10);
+  return true;
+}
+
+void SoftwareI2CGroup::setClock(uint32_t frequency) {
+  if (frequency == SOFT_I2C_CLOCK_MAX) {
+    _halfPeriod = 0;
+  } else {
+    uint32_t half = 500000UL / frequency;
+    _halfPeriod = (half > 255) ? 255 : (uint8_t)half;
+  }
+}
+
+uint8_t SoftwareI2CGroup::count() {
+  return _count;
+}
+
+void SoftwareI2CGroup::delayHalf() {
+  if (_halfPeriod > 0) {
+    delayMicroseconds(_halfPeriod);
+  }
+}
+
+uint8_t SoftwareI2CGroup::portMask(uint8_t buses) {
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (buses & (1 << i)) {
+      mask |= _sdaMasks[i];
+    }
+  }
+  return mask;
+}
+
+// Open-drain outputs: lines in lowMask are driven low, every other SDA line
+// in the group is released to its pull-up. Releases happen before drives so
+// no line is ever pushed high.
+void SoftwareI2CGroup::driveSDA(uint8_t lowMask) {
+#if defined(__AVR__)
+  uint8_t release = _groupMask & ~lowMask;
+  uint8_t oldSREG = SREG;
+  cli();
+  *_sdaDDR &= ~release;
+  *_sdaPort = (*_sdaPort & ~_groupMask) | release;
+  *_sdaDDR |= lowMask;
+  SREG = oldSREG;
+#else
+  for (uint8_t i = 0; i < _count; i++) {
+    if (lowMask & _sdaMasks[i]) {
+      pinMode(_sdaPins[i], OUTPUT);
+      digitalWrite(_sdaPins[i], LOW);
+    } else {
+      pinMode(_sdaPins[i], INPUT_PULLUP);
+    }
+  }
+#endif
+}
+
+// Sample every SDA line, result in port bit space
+uint8_t SoftwareI2CGroup::readSDA() {
+#if defined(__AVR__)
+  return *_sdaPinReg & _groupMask;
+#else
+  uint8_t pins = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (digitalRead(_sdaPins[i])) {
+      pins |= _sdaMasks[i];
+    }
+  }
+  return pins;
+#endif
+}
+
+void SoftwareI2CGroup::setSCL(bool high) {
+  if (high) {
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli();
+    *_sclDDR &= ~_sclMask;           // Release
+    *_sclPort |= _sclMask;
+    SREG = oldSREG;
+#else
+    pinMode(_sclPin, INPUT_PULLUP);  // Release
+#endif
+    // Clock stretching: SCL is shared, so any slave holding it low
+    // stretches every bus
+    uint16_t timeout = 1000;
+    while (!readSCL() && timeout > 0) {
+      delayMicroseconds(1);
+      timeout--;
+    }
+  } else {
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli();
+    *_sclPort &= ~_sclMask;          // Pull low
+    *_sclDDR |= _sclMask;
+    SREG = oldSREG;
+#else
+    pinMode(_sclPin, OUTPUT);
+    digitalWrite(_sclPin, LOW);      // Pull low
+#endif
+  }
+  delayHalf();
+}
+
+bool SoftwareI2CGroup::readSCL() {
+#if defined(__AVR__)
+  return (*_sclPinReg & _sclMask) != 0;
+#else
+  return digitalRead(_sclPin);
+#endif
+}
+
+void SoftwareI2CGroup::startCondition() {
+  // Also used as the repeated START: SCL is low after the pointer write
+  driveSDA(0);
+  setSCL(true);
+  driveSDA(_groupMask);  // START condition on every bus
+  delayHalf();
+  setSCL(false);
+}
+
+void SoftwareI2CGroup::stopCondition() {
+  driveSDA(_groupMask);
+  setSCL(true);
+  driveSDA(0);           // STOP condition on every bus
+  delayHalf();
+}
+
+// Clock one byte per bus MSB first, then sample the ACK bit. Buses not in
+// buses keep SDA released so their (NACKed) device sees only ones.
+uint8_t SoftwareI2CGroup::writeByte(uint8_t buses, const uint8_t* data, uint8_t stride) {
+  for (uint8_t bit = 0x80; bit != 0; bit >>= 1) {
+    uint8_t lowMask = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      if ((buses & (1 << i)) && !(data[i * stride] & bit)) {
+        lowMask |= _sdaMasks[i];
+      }
+    }
+    driveSDA(lowMask);
+    setSCL(true);
+    setSCL(false);
+  }
+
+  // ACK is low
+  driveSDA(0);
+  setSCL(true);
+  uint8_t pins = readSDA();
+  setSCL(false);
+
+  uint8_t acked = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    if ((buses & (1 << i)) && !(pins & _sdaMasks[i])) {
+      acked |= 1 << i;
+    }
+  }
+  return acked;
+}
+
+// Clock one byte in from every bus and demultiplex it into data[i * stride]
+void SoftwareI2CGroup::readByte(uint8_t buses, uint8_t* data, uint8_t stride, bool ack) {
+  for (uint8_t i = 0; i < _count; i++) {
+    data[i * stride] = 0;
+  }
+
+  driveSDA(0);  // Release SDA
+  for (uint8_t b = 0; b < 8; b++) {
+    setSCL(true);
+    uint8_t pins = readSDA();
+    setSCL(false);
+
+    for (uint8_t i = 0; i < _count; i++) {
+      data[i * stride] = (data[i * stride] << 1) | ((pins & _sdaMasks[i]) ? 1 : 0);
+    }
+  }
+
+  // Send ACK/NACK on the buses still in the transaction
+  driveSDA(ack ? portMask(buses) : 0);
+  setSCL(true);
+  setSCL(false);
+}
+
+uint8_t SoftwareI2CGroup::writeRegisters(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) {
+  uint8_t buses = (1 << _count) - 1;
+  if (buses == 0) {
+    return 0;
+  }
+
+  startCondition();
+
+  uint8_t header = address << 1;  // Write bit
+  buses = writeByte(buses, &header, 0);
+  buses = writeByte(buses, &reg, 0);
+  for (uint8_t j = 0; j < length && buses != 0; j++) {
+    buses = writeByte(buses, data + j, length);
+  }
+
+  stopCondition();
+  return buses;
+}
+
+uint8_t SoftwareI2CGroup::readRegisters(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) {
+  uint8_t buses = (1 << _count) - 1;
+  if (buses == 0 || length == 0) {
+    return 0;
+  }
+
+  // Register pointer, then repeated START in read mode
+  startCondition();
+  uint8_t header = address << 1;
+  buses = writeByte(buses, &header, 0);
+  buses = writeByte(buses, &reg, 0);
+  if (buses == 0) {
+    stopCondition();
+    return 0;
+  }
+
+  startCondition();
+  header = (address << 1) | 1;
+  buses = writeByte(buses, &header, 0);
+  if (buses == 0) {
+    stopCondition();
+    return 0;
+  }
+
+  // ACK all but the last byte
+  for (uint8_t j = 0; j < length; j++) {
+    readByte(buses, buffer + j, length, j < length - 1);
+  }
+
+  stopCondition();
+  return buses;
+}
@@ -0,0 +1,96 @@
+/*
+ * SoftwareI2CGroup.h
+ *
+ * Several bit-banged I2C buses clocked in lockstep: one shared SCL line and
+ * up to 8 SDA lines on the same AVR port. Every bus runs the same
+ * transaction (same address, same register, same length) at the same time,
+ * so reading one controller per bus costs the bus time of a single read.
+ *
+ * Each SDA line is driven and sampled independently, so write data may
+ * differ per bus. Buffers are laid out bus by bus: bus i uses
+ * buffer[i * length] .. buffer[i * length + length - 1].
+ *
+ *   const uint8_t sda[] = {22, 23, 24};   // PA0-PA2 on a Mega
+ *   SoftwareI2CGroup chains(sda, 3, 25);  // Shared SCL on PA3
+ *   uint8_t encoders[3 * 8];
+ *   uint8_t ok = chains.readRegisters(0x01, 0x50, encoders, 8);
+ *   // bit i of ok set when bus i answered
+ */
+
+#ifndef SOFTWAREI2CGROUP_H
+#define SOFTWAREI2CGROUP_H
+
+#include <Arduino.h>
+
+// Maximum number of SDA lines (one AVR port)
+#define SOFT_I2C_GROUP_MAX 8
+
+// setClock() value for the fastest rate the pins can toggle (no added delay)
+#ifndef SOFT_I2C_CLOCK_MAX
+#define SOFT_I2C_CLOCK_MAX 0
+#endif
+
+class SoftwareI2CGroup {
+  public:
+    SoftwareI2CGroup(const uint8_t sdaPins[], uint8_t count, uint8_t sclPin);
+
+    // Release all lines. Returns false on AVR if the SDA pins are not all
+    // on one port or SCL shares a bit with them.
+    bool begin();
+
+    // Set the target SCL frequency in Hz or SOFT_I2C_CLOCK_MAX.
+    // Default 100000.
+    void setClock(uint32_t frequency);
+
+    // Number of buses in the group
+    uint8_t count();
+
+    // Write length bytes starting at reg on every bus; bus i sends
+    // data[i * length ..]. Returns a bit mask of the buses whose device
+    // acknowledged every byte.
+    uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
+
+    // Read length bytes starting at reg from every bus (repeated START
+    // after the pointer write); bus i fills buffer[i * length ..].
+    // Returns a bit mask of the buses whose device answered.
+    uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length);
+
+  private:
+    uint8_t _sdaPins[SOFT_I2C_GROUP_MAX];
+    uint8_t _sdaMasks[SOFT_I2C_GROUP_MAX];  // Line of each bus in port bit space
+    uint8_t _groupMask;                     // All SDA lines
+    uint8_t _count;
+    uint8_t _sclPin;
+    uint8_t _halfPeriod;                    // Delay per half clock (microseconds)
+
+#if defined(__AVR__)
+    // Direct port access, resolved once in begin()
+    volatile uint8_t* _sdaDDR;
+    volatile uint8_t* _sdaPort;
+    volatile uint8_t* _sdaPinReg;
+    volatile uint8_t* _sclDDR;
+    volatile uint8_t* _sclPort;
+    volatile uint8_t* _sclPinReg;
+    uint8_t _sclMask;
+#endif
+
+    // Low-level bit-bang functions, SDA masks in port bit space
+    void driveSDA(uint8_t lowMask);
+    uint8_t readSDA();
+    void setSCL(bool high);
+    bool readSCL();
+    void delayHalf();
+
+    // Bus-index mask (bit i = bus i) to port bit mask
+    uint8_t portMask(uint8_t buses);
+
+    // Lockstep protocol functions, buses as bus-index masks
+    void startCondition();
+    void stopCondition();
+    // Byte for bus i at data[i * stride]; stride 0 sends the same byte
+    // everywhere. Returns the buses that acknowledged.
+    uint8_t writeByte(uint8_t buses, const uint8_t* data, uint8_t stride);
+    void readByte(uint8_t buses, uint8_t* data, uint8_t stride, bool ack);
+};
+
+#endif